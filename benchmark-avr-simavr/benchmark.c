@@ -0,0 +1,306 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+/*
+ * This is benchmark of Aiko for atmega8, which should be run in simavr. It
+ * counts cycles of processor with Timer1 and prints results over UART, one
+ * line for each of measurements. When it is done, it sleeps with interrupts
+ * disabled, then simavr stops.
+ */
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+
+#include "kernel.h"
+#include "signal_set.h"
+
+/** \def BENCHMARK_PROCESSES
+ * This is count of processes in benchmark kernel.
+ */
+#define BENCHMARK_PROCESSES 8
+
+/** \def BENCHMARK_SIGNALS
+ * This is count of signal processes, they are at end of processes table.
+ */
+#define BENCHMARK_SIGNALS 4
+
+/** \def BENCHMARK_ROUNDS
+ * This is count of rounds of each measurement.
+ */
+#define BENCHMARK_ROUNDS 16
+
+/** \def BENCHMARK_BAUD_RATE
+ * This is value of UBRR register.
+ */
+#define BENCHMARK_BAUD_RATE (F_CPU / 16 / 9600 - 1)
+
+/** \struct benchmark_result_t
+ * This store result of one measurement.
+ */
+typedef struct {
+
+    /* This store sum of cycles of all operations */
+    uint32_t sum;
+
+    /* This store count of operations */
+    uint16_t count;
+
+    /* This store cycles of slowest operation */
+    uint16_t max;
+
+} benchmark_result_t;
+
+/* This store processes of benchmark kernel */
+static process_t processes[BENCHMARK_PROCESSES];
+
+/* This store benchmark kernel */
+static kernel_instance_t kernel;
+
+/* This store cycles of empty measurement */
+static uint16_t overhead;
+
+/* This store last message, so workers are not optimized out */
+static volatile uintptr_t sink;
+
+/** \fn benchmark_worker
+ * This is worker of reactive and signal processes.
+ * @param *kernel Kernel instance
+ * @param *process Process to work on
+ */
+static void benchmark_worker(kernel_instance_t *kernel, process_t *process) {
+    (void)(kernel);
+
+    sink = (uintptr_t)(message_box_receive(process->message));
+}
+
+#ifdef AIKO_COMPACT_PROCESS
+PROCESS_WORKERS(PROCESS_WORKER(benchmark_worker));
+#endif
+
+/** \fn uart_create
+ * This prepare UART to sending.
+ */
+static void uart_create(void) {
+    UBRRH = (uint8_t)(BENCHMARK_BAUD_RATE >> 8);
+    UBRRL = (uint8_t)(BENCHMARK_BAUD_RATE);
+    UCSRB = _BV(TXEN);
+    UCSRC = _BV(URSEL) | _BV(UCSZ1) | _BV(UCSZ0);
+}
+
+/** \fn uart_send
+ * This send one character over UART.
+ * @param character Character to send
+ */
+static void uart_send(char character) {
+    while (!(UCSRA & _BV(UDRE)));
+
+    UDR = character;
+}
+
+/** \fn uart_send_string
+ * This send string over UART.
+ * @param *string String to send
+ */
+static void uart_send_string(const char *string) {
+    while (*string != '\0') uart_send(*string++);
+}
+
+/** \fn uart_send_number
+ * This send decimal number over UART.
+ * @param number Number to send
+ */
+static void uart_send_number(uint32_t number) {
+    char digits[10];
+    uint8_t count = 0x00;
+
+    do {
+        digits[count++] = (char)('0' + number % 10);
+        number = number / 10;
+    } while (number != 0x00);
+
+    while (count != 0x00) uart_send(digits[--count]);
+}
+
+/** \fn timer_start
+ * This start Timer1 from zero, it counts each cycle of processor.
+ */
+static inline void timer_start(void) {
+    TCCR1B = 0x00;
+    TCNT1 = 0x00;
+    TCCR1B = _BV(CS10);
+}
+
+/** \fn timer_stop
+ * This stop Timer1 and return counted cycles without cycles of empty 
+ * measurement.
+ * @return Cycles from timer_start
+ */
+static inline uint16_t timer_stop(void) {
+    uint16_t cycles = TCNT1;
+
+    TCCR1B = 0x00;
+    return cycles - overhead;
+}
+
+/** \fn benchmark_add
+ * This add cycles of one operation to result.
+ * @param *result Result to work on
+ * @param cycles Cycles of operation
+ * @param count Count of operations done in that cycles
+ */
+static void benchmark_add(
+    benchmark_result_t *result, 
+    uint16_t cycles,
+    uint16_t count
+) {
+    result->sum += cycles;
+    result->count += count;
+
+    if (cycles / count > result->max) result->max = cycles / count;
+}
+
+/** \fn benchmark_report
+ * This print result over UART, as name, average and max cycles.
+ * @param *name Name of measurement
+ * @param *result Result to print
+ */
+static void benchmark_report(
+    const char *name, 
+    const benchmark_result_t *result
+) {
+    uart_send_string(name);
+    uart_send(' ');
+    uart_send_number(result->sum / result->count);
+    uart_send(' ');
+    uart_send_number(result->max);
+    uart_send_string("\r\n");
+}
+
+/** \fn benchmark_create
+ * This create benchmark kernel, with reactive processes at begin and signal
+ * processes at end.
+ */
+static void benchmark_create(void) {
+    kernel_create_static(&kernel, processes, BENCHMARK_PROCESSES);
+
+    for (kernel_pid_t pid = 0x00; pid < BENCHMARK_PROCESSES; ++pid) {
+        process_type_t type = REACTIVE;
+
+        if (pid >= BENCHMARK_PROCESSES - BENCHMARK_SIGNALS) type = SIGNAL;
+
+        kernel_create_process(&kernel, pid, type, benchmark_worker, NULL);
+    }
+}
+
+/** \fn benchmark_send
+ * This measure kernel_process_message_box_send to each process.
+ */
+static void benchmark_send(void) {
+    benchmark_result_t result = { 0x00, 0x00, 0x00 };
+
+    for (uint8_t round = 0x00; round < BENCHMARK_ROUNDS; ++round) {
+        for (kernel_pid_t pid = 0x00; pid < BENCHMARK_PROCESSES; ++pid) {
+            void *message = (void *)(uintptr_t)(pid);
+
+            timer_start();
+            kernel_process_message_box_send(&kernel, pid, message);
+            benchmark_add(&result, timer_stop(), 0x01);
+        }
+
+        kernel_run_once(&kernel);
+    }
+
+    benchmark_report("send", &result);
+}
+
+/** \fn benchmark_dispatch
+ * This measure pass of scheduler without ready processes, and pass with all
+ * processes ready, divided by count of processes. Pass is run by 
+ * kernel_run_pass, so check for work after it is not measured.
+ */
+static void benchmark_dispatch(void) {
+    benchmark_result_t idle = { 0x00, 0x00, 0x00 };
+    benchmark_result_t dispatch = { 0x00, 0x00, 0x00 };
+
+    for (uint8_t round = 0x00; round < BENCHMARK_ROUNDS; ++round) {
+        timer_start();
+        kernel_run_pass(&kernel);
+        benchmark_add(&idle, timer_stop(), 0x01);
+
+        for (kernel_pid_t pid = 0x00; pid < BENCHMARK_PROCESSES; ++pid) {
+            void *message = (void *)(uintptr_t)(pid);
+
+            kernel_process_message_box_send(&kernel, pid, message);
+        }
+
+        timer_start();
+        kernel_run_pass(&kernel);
+        benchmark_add(&dispatch, timer_stop(), BENCHMARK_PROCESSES);
+    }
+
+    benchmark_report("idle_pass", &idle);
+    benchmark_report("dispatch", &dispatch);
+}
+
+/** \fn benchmark_trigger_signal
+ * This measure kernel_trigger_signal, which wakes all signal processes.
+ */
+static void benchmark_trigger_signal(void) {
+    benchmark_result_t result = { 0x00, 0x00, 0x00 };
+
+    for (uint8_t round = 0x00; round < BENCHMARK_ROUNDS; ++round) {
+        timer_start();
+        kernel_trigger_signal(&kernel, round);
+        benchmark_add(&result, timer_stop(), 0x01);
+
+        kernel_run_once(&kernel);
+    }
+
+    benchmark_report("trigger_signal", &result);
+}
+
+/** \fn benchmark_signal_set
+ * This measure signal_set_raise, which wakes all signal processes.
+ */
+static void benchmark_signal_set(void) {
+    benchmark_result_t result = { 0x00, 0x00, 0x00 };
+
+    for (uint8_t round = 0x00; round < BENCHMARK_ROUNDS; ++round) {
+        timer_start();
+        signal_set_raise(&kernel, round);
+        benchmark_add(&result, timer_stop(), 0x01);
+
+        kernel_run_once(&kernel);
+    }
+
+    benchmark_report("signal_set_raise", &result);
+}
+
+int main(void) {
+    uart_create();
+
+    overhead = 0x00;
+    timer_start();
+    overhead = timer_stop();
+
+    benchmark_create();
+    benchmark_send();
+    benchmark_dispatch();
+    benchmark_trigger_signal();
+    benchmark_signal_set();
+
+    cli();
+    sleep_enable();
+    sleep_cpu();
+
+    return 0;
+}
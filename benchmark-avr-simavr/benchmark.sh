@@ -0,0 +1,85 @@
+#!/bin/bash
+
+# Run it before release, and compare output with output of last release:
+# ./benchmark.sh > current.txt && diff release.txt current.txt
+
+SOURCES=("kernel.c message_box.c process.c deferred.c task.c signal_set.c latency.c pipeline.c snapshot.c conflate.c select.c")
+SOURCES_DIR=../sources/
+
+# Each line is one set of switches, which is measured with and without
+# AIKO_SHORT_NUMBERS. Without process parameter, pipeline.c is skipped.
+FEATURES=(
+    "-DAIKO_DEFAULT"
+    "-DAIKO_COMPACT_PROCESS"
+    "-DAIKO_NO_PROCESS_PARAMETER"
+    "-DAIKO_COMPACT_PROCESS -DAIKO_NO_PROCESS_PARAMETER"
+    "-DAIKO_MESSAGE_PAYLOAD_SIZE=4"
+    "-DAIKO_LATENCY"
+    "-DAIKO_SEGMENTED_KERNEL"
+    "-DAIKO_STATISTICS"
+)
+NUMBERS=("-DAIKO_LONG_NUMBERS" "-DAIKO_SHORT_NUMBERS")
+
+OBJECTS_DIR=./objects/
+FIRMWARE=./benchmark.elf
+
+CC="avr-gcc"
+CC_FLAGS="-Wall -Wextra -Wpedantic -Os -std=c99 -fearly-inlining \
+    -fshort-enums -Wl,--gc-sections -fdata-sections \
+    -ffunction-sections -mmcu=atmega8 -DF_CPU=8000000UL"
+
+SIZE="avr-size"
+
+SIMULATOR="simavr"
+SIMULATOR_FLAGS="-m atmega8 -f 8000000"
+SIMULATOR_TIMEOUT=60
+
+mkdir -p $OBJECTS_DIR
+
+for NUMBER in "${NUMBERS[@]}"; do
+    for FEATURE in "${FEATURES[@]}"; do
+        NAME="$(echo $NUMBER $FEATURE | sed -e 's/-DAIKO_//g' -e 's/ /+/g')"
+        FILES=""
+
+        rm $OBJECTS_DIR/*.o -f
+
+        for SOURCE in $SOURCES; do
+            if [[ "$FEATURE" == *NO_PROCESS_PARAMETER* ]] && \
+                [[ "$SOURCE" == "pipeline.c" ]]; then
+                continue
+            fi
+
+            OBJECT="$OBJECTS_DIR/$(basename $SOURCE .c).o"
+
+            $CC $CC_FLAGS $NUMBER $FEATURE -c $SOURCES_DIR/$SOURCE -o $OBJECT
+            FILES="$FILES $SOURCES_DIR/$SOURCE"
+        done
+
+        # Size of each of feature files, in text, data and bss columns
+        $SIZE $OBJECTS_DIR/*.o | tail -n +2 | while read TEXT DATA BSS REST; do
+            FILE="$(basename $(echo $REST | awk '{ print $3 }'))"
+
+            echo "size $NAME $FILE $TEXT $DATA $BSS"
+        done
+
+        # Size of whole benchmark, only with code which it uses
+        $CC $CC_FLAGS $NUMBER $FEATURE -I$SOURCES_DIR benchmark.c $FILES \
+            -o $FIRMWARE
+
+        $SIZE $FIRMWARE | tail -n +2 | while read TEXT DATA BSS REST; do
+            echo "size $NAME firmware $TEXT $DATA $BSS"
+        done
+
+        # Cycles, each line is name, average and max. Simulator prints UART
+        # with its own log, sometimes in color, so only results are taken.
+        timeout $SIMULATOR_TIMEOUT $SIMULATOR $SIMULATOR_FLAGS $FIRMWARE \
+            2>&1 | sed -e 's/\x1b\[[0-9;]*m//g' -e 's/\r//g' | \
+            grep -E '^[a-z_]+ [0-9]+ [0-9]+$' | \
+            while read MEASUREMENT AVERAGE MAX; do
+                echo "cycles $NAME $MEASUREMENT $AVERAGE $MAX"
+            done
+    done
+done
+
+rm $OBJECTS_DIR -rf
+rm $FIRMWARE -f
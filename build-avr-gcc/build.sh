@@ -1,12 +1,16 @@
 #!/bin/bash
 
-SOURCES=("kernel.c message_box.c process.c")
+SOURCES=("kernel.c message_box.c process.c deferred.c task.c signal_set.c latency.c pipeline.c snapshot.c conflate.c select.c power.c")
 SOURCES_DIR=../sources/
 
 LIB=./libaiko.a
 OBJECTS_DIR=./
 
 CC="avr-gcc"
+
+# Add -DAIKO_COMPACT_PROCESS and -DAIKO_NO_PROCESS_PARAMETER to make processes
+# smaller, see howto.md. Project must be compiled with same switches. Without
+# process parameter, remove pipeline.c from SOURCES.
 CC_FLAGS="-Wall -Wextra -Wpedantic -Os -std=c99 -fearly-inlining \
     -fshort-enums -Wl,--gc-sections -fdata-sections \
     -ffunction-sections -DAIKO_SHORT_NUMBERS -mmcu=atmega8"
@@ -1,13 +1,13 @@
 #!/bin/bash
 
-SOURCES=("kernel.c message_box.c process.c")
+SOURCES=("kernel.c message_box.c process.c deferred.c task.c signal_set.c latency.c pipeline.c snapshot.c conflate.c select.c power.c atomic.c async_io.c shared.c")
 SOURCES_DIR=../sources/
 
 LIB=./libaiko.a
 OBJECTS_DIR=./
 
 CC="gcc"
-CC_FLAGS="-Wall -Wextra -Wpedantic -O3 -std=c99"
+CC_FLAGS="-Wall -Wextra -Wpedantic -O3 -std=c99 -pthread"
 
 AR="ar"
 AR_FLAGS="-cq"
@@ -15,5 +15,23 @@
 #include "aiko/process.h"
 #include "aiko/kernel.h"
 #include "aiko/message_box.h"
+#include "aiko/atomic.h"
+#include "aiko/deferred.h"
+#include "aiko/task.h"
+#include "aiko/signal_set.h"
+#include "aiko/latency.h"
+#include "aiko/snapshot.h"
+#include "aiko/conflate.h"
+#include "aiko/select.h"
+#include "aiko/power.h"
+
+#ifndef AIKO_NO_PROCESS_PARAMETER
+#include "aiko/pipeline.h"
+#endif
+
+#ifdef __linux__
+#include "aiko/async_io.h"
+#include "aiko/shared.h"
+#endif
 
 #endif
@@ -0,0 +1,525 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_HPP_INCLUDED
+#define CX_AIKO_HPP_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "aiko.h"
+
+/** \namespace aiko
+ * This is C++ layer over Aiko. Set of processes is known at compile time,
+ * so scheduler calls workers directly, compiler can inline them, and type
+ * of message is checked when it is send. It uses only C++11 language,
+ * without standard library, so it works with avr-g++ too.
+ */
+namespace aiko {
+
+namespace detail {
+
+/** \struct none
+ * This is message of process, which does not get messages.
+ */
+struct none {};
+
+/** \struct is_pointer
+ * This check if type is pointer.
+ */
+template <typename Type>
+struct is_pointer {
+    static const bool value = false;
+};
+
+template <typename Type>
+struct is_pointer<Type *> {
+    static const bool value = true;
+};
+
+/** \struct is_same
+ * This check if both types are the same type.
+ */
+template <typename First, typename Second>
+struct is_same {
+    static const bool value = false;
+};
+
+template <typename Type>
+struct is_same<Type, Type> {
+    static const bool value = true;
+};
+
+/** \struct decay
+ * This remove reference, const and volatile from type.
+ */
+template <typename Type>
+struct decay {
+    typedef Type type;
+};
+
+template <typename Type>
+struct decay<Type &> {
+    typedef typename decay<Type>::type type;
+};
+
+template <typename Type>
+struct decay<Type &&> {
+    typedef typename decay<Type>::type type;
+};
+
+template <typename Type>
+struct decay<const Type> {
+    typedef typename decay<Type>::type type;
+};
+
+template <typename Type>
+struct decay<volatile Type> {
+    typedef typename decay<Type>::type type;
+};
+
+template <typename Type>
+struct decay<const volatile Type> {
+    typedef typename decay<Type>::type type;
+};
+
+/** \struct codec
+ * This send and receive message of given type. Pointers are send as they
+ * are, values which fit in pointer are send inside it, bigger values are
+ * send in payload of message box.
+ */
+template <
+    typename Type,
+    bool Pointer = is_pointer<Type>::value,
+    bool Small = (sizeof(Type) <= sizeof(void *))
+>
+struct codec {
+    static_assert(
+        Pointer || Small,
+        "Message does not fit into pointer, define AIKO_MESSAGE_PAYLOAD_SIZE"
+    );
+};
+
+template <typename Type, bool Small>
+struct codec<Type, true, Small> {
+    static void send(
+        kernel_instance_t *kernel,
+        kernel_pid_t pid,
+        Type value
+    ) {
+        void *message = const_cast<void *>(static_cast<const void *>(value));
+
+        kernel_process_message_box_send(kernel, pid, message);
+    }
+
+    static Type receive(message_box_t *box) {
+        return static_cast<Type>(message_box_receive(box));
+    }
+};
+
+template <typename Type>
+struct codec<Type, false, true> {
+    static void send(
+        kernel_instance_t *kernel,
+        kernel_pid_t pid,
+        const Type &value
+    ) {
+        uintptr_t message = 0x00;
+
+        memcpy(&message, &value, sizeof(Type));
+        kernel_process_message_box_send(
+            kernel,
+            pid,
+            reinterpret_cast<void *>(message)
+        );
+    }
+
+    static Type receive(message_box_t *box) {
+        void *message = message_box_receive(box);
+        uintptr_t raw = reinterpret_cast<uintptr_t>(message);
+        Type value;
+
+        memcpy(&value, &raw, sizeof(Type));
+        return value;
+    }
+};
+
+#ifdef AIKO_MESSAGE_PAYLOAD_SIZE
+
+template <typename Type>
+struct codec<Type, false, false> {
+    static_assert(
+        sizeof(Type) <= AIKO_MESSAGE_PAYLOAD_SIZE,
+        "Message does not fit into AIKO_MESSAGE_PAYLOAD_SIZE"
+    );
+
+    static void send(
+        kernel_instance_t *kernel,
+        kernel_pid_t pid,
+        const Type &value
+    ) {
+        kernel_process_message_box_send_value(
+            kernel,
+            pid,
+            &value,
+            sizeof(Type)
+        );
+    }
+
+    static Type receive(message_box_t *box) {
+        Type value;
+
+        message_box_receive_value(box, &value, sizeof(Type));
+        return value;
+    }
+};
+
+#endif
+
+/** \struct index_of
+ * This return position of worker in set of workers, or size of set when
+ * worker is not in set.
+ */
+template <typename Worker, typename... Workers>
+struct index_of {
+    static const kernel_pid_t value = 0x00;
+};
+
+template <typename Worker, typename First, typename... Rest>
+struct index_of<Worker, First, Rest...> {
+    static const kernel_pid_t value = 1 + index_of<Worker, Rest...>::value;
+};
+
+template <typename Worker, typename... Rest>
+struct index_of<Worker, Worker, Rest...> {
+    static const kernel_pid_t value = 0x00;
+};
+
+/** \struct is_unique
+ * This check if each of workers is in set only once.
+ */
+template <typename... Workers>
+struct is_unique {
+    static const bool value = true;
+};
+
+template <typename First, typename... Rest>
+struct is_unique<First, Rest...> {
+    static const bool value =
+        index_of<First, Rest...>::value == sizeof...(Rest) &&
+        is_unique<Rest...>::value;
+};
+
+/** \struct invoke
+ * This receive message of process and call worker with it.
+ */
+template <process_type_t Type>
+struct invoke {
+    template <typename Worker, typename System>
+    static void run(System &system, process_t *process) {
+        typedef codec<typename Worker::message> message;
+
+        Worker::run(system, message::receive(process->message));
+    }
+};
+
+template <>
+struct invoke<CONTINUOUS> {
+    template <typename Worker, typename System>
+    static void run(System &system, process_t *process) {
+        (void)(process);
+        Worker::run(system);
+    }
+};
+
+/** \struct create
+ * This create processes of given workers, from given pid.
+ */
+template <kernel_pid_t Pid, typename... Workers>
+struct create {
+    template <typename System>
+    static void run(System &system) {
+        (void)(system);
+    }
+};
+
+template <kernel_pid_t Pid, typename Worker, typename... Rest>
+struct create<Pid, Worker, Rest...> {
+    template <typename System>
+    static void run(System &system) {
+        kernel_create_process(
+            system.kernel(),
+            Pid,
+            Worker::type,
+            &System::template worker<Worker>,
+            NULL
+        );
+
+        create<Pid + 1, Rest...>::run(system);
+    }
+};
+
+/** \fn is_ready
+ * This check if process would be executed by scheduler.
+ * @param *process Process to check
+ * @return True if process is ready to execute
+ */
+template <typename Worker>
+inline bool is_ready(process_t *process) {
+    if (PROCESS_GET_TYPE(process) == EMPTY) return false;
+    if (Worker::type == CONTINUOUS) return true;
+
+    return message_box_is_readable(process->message);
+}
+
+/** \struct pass
+ * This run each of ready processes once. Loop over processes is unrolled
+ * by compiler, and each worker is called directly.
+ */
+template <kernel_pid_t Pid, typename... Workers>
+struct pass {
+    template <typename System>
+    static uint_t run(System &system) {
+        (void)(system);
+        return 0x00;
+    }
+};
+
+template <kernel_pid_t Pid, typename Worker, typename... Rest>
+struct pass<Pid, Worker, Rest...> {
+    template <typename System>
+    static uint_t run(System &system) {
+        process_t *process = system.process(Pid);
+        uint_t count = 0x00;
+
+        if (is_ready<Worker>(process)) {
+#ifdef AIKO_LATENCY
+            kernel_record_latency(system.kernel(), Pid);
+#endif
+            invoke<Worker::type>::template run<Worker>(system, process);
+            count = 0x01;
+        }
+
+        return count + pass<Pid + 1, Rest...>::run(system);
+    }
+};
+
+}
+
+/** \struct reactive
+ * This is base of worker, which runs when message is send to it. Worker
+ * must have function:
+ * template <typename System> static void run(System &, Message);
+ */
+template <typename Message>
+struct reactive {
+    typedef Message message;
+    static const process_type_t type = REACTIVE;
+};
+
+/** \struct continuous
+ * This is base of worker, which runs whenever processor does not doing
+ * anything. Worker must have function:
+ * template <typename System> static void run(System &);
+ */
+struct continuous {
+    typedef detail::none message;
+    static const process_type_t type = CONTINUOUS;
+};
+
+/** \struct signal
+ * This is base of worker, which runs when signal is triggered. Worker must
+ * have function:
+ * template <typename System> static void run(System &, uintptr_t);
+ */
+struct signal {
+    typedef uintptr_t message;
+    static const process_type_t type = SIGNAL;
+};
+
+/** \class system
+ * This is kernel with set of processes given at compile time. Each worker
+ * gets pid equal to its position in set, and it is created with kernel.
+ * With AIKO_COMPACT_PROCESS, project must put system::worker of each of
+ * workers into PROCESS_WORKERS.
+ */
+template <typename... Workers>
+class system {
+    static_assert(sizeof...(Workers) > 0x00, "System must have processes");
+    static_assert(
+        detail::is_unique<Workers...>::value,
+        "Each worker can be in system only once"
+    );
+
+public:
+
+    /** \var size
+     * This is count of processes in system.
+     */
+    static const kernel_pid_t size = sizeof...(Workers);
+
+    /** \fn system
+     * This create kernel and all of processes.
+     */
+    system() {
+        kernel_create_static(&instance, processes, size);
+        detail::create<0x00, Workers...>::run(*this);
+    }
+
+    /** \fn ~system
+     * This remove kernel.
+     */
+    ~system() {
+        kernel_remove_static(&instance);
+    }
+
+    /** \fn pid
+     * This return pid of process with given worker.
+     * @return Pid of process
+     */
+    template <typename Worker>
+    static constexpr kernel_pid_t pid() {
+        static_assert(
+            detail::index_of<Worker, Workers...>::value < size,
+            "Worker is not in system"
+        );
+
+        return detail::index_of<Worker, Workers...>::value;
+    }
+
+    /** \fn kernel
+     * This return kernel, it can be used with C functions of Aiko.
+     * @return Kernel instance
+     */
+    kernel_instance_t* kernel() {
+        return &instance;
+    }
+
+    /** \fn process
+     * This return process with given pid.
+     * @param pid Pid of process
+     * @return Process with given pid
+     */
+    process_t* process(kernel_pid_t pid) {
+        return processes + pid;
+    }
+
+    /** \fn is_sendable
+     * This check if message can be send to process with given worker.
+     * @return True if message box is sendable, false if not
+     */
+    template <typename Worker>
+    bool is_sendable() {
+        return message_box_is_sendable(processes[pid<Worker>()].message);
+    }
+
+    /** \fn send
+     * This send message to process with given worker. Message must have
+     * exactly type of worker message, it is not converted.
+     * @param &&value Message to send
+     * @return True if message had been send, false when box is full
+     */
+    template <typename Worker, typename Message>
+    bool send(Message &&value) {
+        static_assert(
+            Worker::type != CONTINUOUS,
+            "Continuous process does not get messages"
+        );
+        static_assert(
+            detail::is_same<
+                typename detail::decay<Message>::type,
+                typename Worker::message
+            >::value,
+            "Message must have type of worker message"
+        );
+
+        if (!is_sendable<Worker>()) return false;
+
+        typedef detail::codec<typename Worker::message> message;
+
+        message::send(&instance, pid<Worker>(), value);
+        return true;
+    }
+
+    /** \fn run_once
+     * This run deferred work, and then each of ready processes once.
+     * @return Count of executed processes
+     */
+    uint_t run_once() {
+#ifdef AIKO_STATISTICS
+        kernel_time_t start = 0x00;
+
+        if (instance.clock != NULL) start = instance.clock();
+#endif
+
+        if (instance.deferred != NULL || instance.polls != NULL) {
+            kernel_deferred_drain(&instance);
+        }
+
+        uint_t dispatched = detail::pass<0x00, Workers...>::run(*this);
+
+#ifdef AIKO_STATISTICS
+        kernel_record_pass(&instance, start, dispatched);
+#endif
+
+        return dispatched;
+    }
+
+    /** \fn scheduler
+     * This run processes until stop is called.
+     */
+    void scheduler() {
+        while (instance.size != 0x00) run_once();
+    }
+
+    /** \fn stop
+     * This stop scheduler.
+     */
+    void stop() {
+        instance.size = 0x00;
+    }
+
+    /** \fn worker
+     * This is worker, which C kernel calls, it calls worker of given type.
+     * @param *kernel Kernel instance, first member of system
+     * @param *process Process to work on
+     */
+    template <typename Worker>
+    static void worker(kernel_instance_t *kernel, process_t *process) {
+        system &self = *reinterpret_cast<system *>(kernel);
+
+        detail::invoke<Worker::type>::template run<Worker>(self, process);
+    }
+
+private:
+
+    /* This store kernel, it must be first member */
+    kernel_instance_t instance;
+
+    /* This store processes */
+    process_t processes[sizeof...(Workers)];
+
+};
+
+/** \fn send
+ * This send message to process with given worker. Message must have 
+ * exactly type of worker message, it is not converted.
+ * @param &system System to work on
+ * @param &&value Message to send
+ * @return True if message had been send, false when box is full
+ */
+template <typename Worker, typename System, typename Message>
+inline bool send(System &system, Message &&value) {
+    return system.template send<Worker>(value);
+}
+
+}
+
+#endif
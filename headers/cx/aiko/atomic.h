@@ -0,0 +1,443 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_ATOMIC_H_INCLUDED
+#define CX_AIKO_ATOMIC_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "numbers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * On AVR critical section disables interrupts, and atomic operations are 
+ * done inside critical section. On other platforms critical section blocks
+ * signals, and atomic operations are lock free, so they can be used from
+ * signal handlers and from other threads.
+ */
+#ifdef __AVR__
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/** \typedef critical_state_t
+ * This store state to restore, when critical section ends.
+ */
+typedef uint8_t critical_state_t;
+
+/** \fn critical_enter
+ * This function starts critical section. On AVR it disables interrupts.
+ * @return State to restore by critical_leave
+ */
+static inline critical_state_t critical_enter(void) {
+    critical_state_t state = SREG;
+    cli();
+    return state;
+}
+
+/** \fn critical_leave
+ * This function ends critical section, started by critical_enter.
+ * @param state State returned by critical_enter
+ */
+static inline void critical_leave(critical_state_t state) {
+    SREG = state;
+}
+
+/** \fn atomic_uint_load
+ * This function atomic load value.
+ * @param *target Value to load
+ * @return Loaded value
+ */
+static inline uint_t atomic_uint_load(uint_t *target) {
+    critical_state_t state = critical_enter();
+    uint_t value = *(volatile uint_t *)(target);
+    critical_leave(state);
+    return value;
+}
+
+/** \fn atomic_uint_store
+ * This function atomic store value.
+ * @param *target Place to store in
+ * @param value Value to store
+ */
+static inline void atomic_uint_store(uint_t *target, uint_t value) {
+    critical_state_t state = critical_enter();
+    *(volatile uint_t *)(target) = value;
+    critical_leave(state);
+}
+
+/** \fn atomic_uint_compare_exchange
+ * This function store desired value, when target has expected value. When
+ * not, it loads current target value into expected.
+ * @param *target Place to work on
+ * @param *expected Expected value
+ * @param desired Value to store
+ * @return True if desired value had been stored, false if not
+ */
+static inline bool atomic_uint_compare_exchange(
+    uint_t *target, 
+    uint_t *expected, 
+    uint_t desired
+) {
+    critical_state_t state = critical_enter();
+    bool result = (*target == *expected);
+
+    if (result) *target = desired;
+    else *expected = *target;
+
+    critical_leave(state);
+    return result;
+}
+
+/** \fn atomic_uint_exchange
+ * This function atomic store value, and return previous value.
+ * @param *target Place to work on
+ * @param value Value to store
+ * @return Value of target before store
+ */
+static inline uint_t atomic_uint_exchange(uint_t *target, uint_t value) {
+    critical_state_t state = critical_enter();
+    uint_t previous = *target;
+
+    *target = value;
+
+    critical_leave(state);
+    return previous;
+}
+
+/** \fn atomic_uint_fetch_add
+ * This function atomic add value to target.
+ * @param *target Place to work on
+ * @param value Value to add
+ * @return Value of target before add
+ */
+static inline uint_t atomic_uint_fetch_add(uint_t *target, uint_t value) {
+    critical_state_t state = critical_enter();
+    uint_t previous = *target;
+
+    *target = previous + value;
+
+    critical_leave(state);
+    return previous;
+}
+
+/** \fn atomic_uint_fetch_sub
+ * This function atomic subtract value from target.
+ * @param *target Place to work on
+ * @param value Value to subtract
+ * @return Value of target before subtract
+ */
+static inline uint_t atomic_uint_fetch_sub(uint_t *target, uint_t value) {
+    critical_state_t state = critical_enter();
+    uint_t previous = *target;
+
+    *target = previous - value;
+
+    critical_leave(state);
+    return previous;
+}
+
+/** \fn atomic_pointer_load
+ * This function atomic load pointer.
+ * @param **target Pointer to load
+ * @return Loaded pointer
+ */
+static inline void *atomic_pointer_load(void **target) {
+    critical_state_t state = critical_enter();
+    void *value = *(void * volatile *)(target);
+    critical_leave(state);
+    return value;
+}
+
+/** \fn atomic_pointer_store
+ * This function atomic store pointer.
+ * @param **target Place to store in
+ * @param *value Pointer to store
+ */
+static inline void atomic_pointer_store(void **target, void *value) {
+    critical_state_t state = critical_enter();
+    *(void * volatile *)(target) = value;
+    critical_leave(state);
+}
+
+/** \fn atomic_pointer_fetch_or
+ * This function atomic logical sum pointer, used as bits, and value.
+ * @param **target Place to work on
+ * @param value Bits to add
+ * @return Bits of target before sum
+ */
+static inline uintptr_t atomic_pointer_fetch_or(
+    void **target, 
+    uintptr_t value
+) {
+    critical_state_t state = critical_enter();
+    uintptr_t previous = (uintptr_t)(*target);
+
+    *target = (void *)(previous | value);
+
+    critical_leave(state);
+    return previous;
+}
+
+/** \fn atomic_pointer_exchange
+ * This function atomic store pointer, and return previous pointer.
+ * @param **target Place to work on
+ * @param *value Pointer to store
+ * @return Pointer in target before store
+ */
+static inline void *atomic_pointer_exchange(void **target, void *value) {
+    critical_state_t state = critical_enter();
+    void *previous = *target;
+
+    *target = value;
+
+    critical_leave(state);
+    return previous;
+}
+
+/** \fn atomic_uint8_or
+ * This function atomic set bits of target.
+ * @param *target Place to work on
+ * @param bits Bits to set
+ */
+static inline void atomic_uint8_or(uint8_t *target, uint8_t bits) {
+    critical_state_t state = critical_enter();
+    *(volatile uint8_t *)(target) |= bits;
+    critical_leave(state);
+}
+
+/** \fn atomic_uint8_and
+ * This function atomic clear bits of target, which are not in mask.
+ * @param *target Place to work on
+ * @param mask Bits to keep
+ */
+static inline void atomic_uint8_and(uint8_t *target, uint8_t mask) {
+    critical_state_t state = critical_enter();
+    *(volatile uint8_t *)(target) &= mask;
+    critical_leave(state);
+}
+
+/** \fn atomic_bool_store
+ * This function atomic store flag.
+ * @param *target Place to store in
+ * @param value Value to store
+ */
+static inline void atomic_bool_store(bool *target, bool value) {
+    *(volatile bool *)(target) = value;
+}
+
+/** \fn atomic_fence
+ * This function orders all memory operations before it with all after it.
+ * On AVR only compiler can reorder them.
+ */
+static inline void atomic_fence(void) {
+    __asm__ __volatile__ ("" ::: "memory");
+}
+
+#else
+
+/** \typedef critical_state_t
+ * This store state to restore, when critical section ends. On Linux it is
+ * signal mask of thread from before critical section, it is stored as 
+ * bytes, so this header does not need POSIX signal.h.
+ */
+typedef struct {
+
+    /* This store bytes of sigset_t */
+    uint64_t mask[16];
+
+} critical_state_t;
+
+/** \fn critical_enter
+ * This function starts critical section. On Linux it blocks signals in
+ * current thread. Critical sections can be nested, each of them restores 
+ * its own state.
+ * @return State to restore by critical_leave
+ */
+critical_state_t critical_enter(void);
+
+/** \fn critical_leave
+ * This function ends critical section, started by critical_enter.
+ * @param state State returned by critical_enter
+ */
+void critical_leave(critical_state_t state);
+
+/** \fn atomic_uint_load
+ * This function atomic load value.
+ * @param *target Value to load
+ * @return Loaded value
+ */
+static inline uint_t atomic_uint_load(uint_t *target) {
+    return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+}
+
+/** \fn atomic_uint_store
+ * This function atomic store value.
+ * @param *target Place to store in
+ * @param value Value to store
+ */
+static inline void atomic_uint_store(uint_t *target, uint_t value) {
+    __atomic_store_n(target, value, __ATOMIC_RELEASE);
+}
+
+/** \fn atomic_uint_compare_exchange
+ * This function store desired value, when target has expected value. When
+ * not, it loads current target value into expected.
+ * @param *target Place to work on
+ * @param *expected Expected value
+ * @param desired Value to store
+ * @return True if desired value had been stored, false if not
+ */
+static inline bool atomic_uint_compare_exchange(
+    uint_t *target, 
+    uint_t *expected, 
+    uint_t desired
+) {
+    return __atomic_compare_exchange_n(
+        target, 
+        expected, 
+        desired, 
+        false, 
+        __ATOMIC_ACQ_REL, 
+        __ATOMIC_ACQUIRE
+    );
+}
+
+/** \fn atomic_uint_exchange
+ * This function atomic store value, and return previous value.
+ * @param *target Place to work on
+ * @param value Value to store
+ * @return Value of target before store
+ */
+static inline uint_t atomic_uint_exchange(uint_t *target, uint_t value) {
+    return __atomic_exchange_n(target, value, __ATOMIC_ACQ_REL);
+}
+
+/** \fn atomic_uint_fetch_add
+ * This function atomic add value to target.
+ * @param *target Place to work on
+ * @param value Value to add
+ * @return Value of target before add
+ */
+static inline uint_t atomic_uint_fetch_add(uint_t *target, uint_t value) {
+    return __atomic_fetch_add(target, value, __ATOMIC_ACQ_REL);
+}
+
+/** \fn atomic_uint_fetch_sub
+ * This function atomic subtract value from target.
+ * @param *target Place to work on
+ * @param value Value to subtract
+ * @return Value of target before subtract
+ */
+static inline uint_t atomic_uint_fetch_sub(uint_t *target, uint_t value) {
+    return __atomic_fetch_sub(target, value, __ATOMIC_ACQ_REL);
+}
+
+/** \fn atomic_pointer_load
+ * This function atomic load pointer.
+ * @param **target Pointer to load
+ * @return Loaded pointer
+ */
+static inline void *atomic_pointer_load(void **target) {
+    return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+}
+
+/** \fn atomic_pointer_store
+ * This function atomic store pointer.
+ * @param **target Place to store in
+ * @param *value Pointer to store
+ */
+static inline void atomic_pointer_store(void **target, void *value) {
+    __atomic_store_n(target, value, __ATOMIC_RELEASE);
+}
+
+/** \fn atomic_pointer_fetch_or
+ * This function atomic logical sum pointer, used as bits, and value. It 
+ * works on pointer itself, so pointer is not accessed as other type.
+ * @param **target Place to work on
+ * @param value Bits to add
+ * @return Bits of target before sum
+ */
+static inline uintptr_t atomic_pointer_fetch_or(
+    void **target, 
+    uintptr_t value
+) {
+    void *previous = __atomic_load_n(target, __ATOMIC_RELAXED);
+    void *desired;
+
+    do {
+        desired = (void *)((uintptr_t)(previous) | value);
+    } while (!__atomic_compare_exchange_n(
+        target, 
+        &previous, 
+        desired, 
+        false, 
+        __ATOMIC_ACQ_REL, 
+        __ATOMIC_RELAXED
+    ));
+
+    return (uintptr_t)(previous);
+}
+
+/** \fn atomic_pointer_exchange
+ * This function atomic store pointer, and return previous pointer.
+ * @param **target Place to work on
+ * @param *value Pointer to store
+ * @return Pointer in target before store
+ */
+static inline void *atomic_pointer_exchange(void **target, void *value) {
+    return __atomic_exchange_n(target, value, __ATOMIC_ACQ_REL);
+}
+
+/** \fn atomic_uint8_or
+ * This function atomic set bits of target.
+ * @param *target Place to work on
+ * @param bits Bits to set
+ */
+static inline void atomic_uint8_or(uint8_t *target, uint8_t bits) {
+    __atomic_fetch_or(target, bits, __ATOMIC_ACQ_REL);
+}
+
+/** \fn atomic_uint8_and
+ * This function atomic clear bits of target, which are not in mask.
+ * @param *target Place to work on
+ * @param mask Bits to keep
+ */
+static inline void atomic_uint8_and(uint8_t *target, uint8_t mask) {
+    __atomic_fetch_and(target, mask, __ATOMIC_ACQ_REL);
+}
+
+/** \fn atomic_bool_store
+ * This function atomic store flag.
+ * @param *target Place to store in
+ * @param value Value to store
+ */
+static inline void atomic_bool_store(bool *target, bool value) {
+    __atomic_store_n(target, value, __ATOMIC_SEQ_CST);
+}
+
+/** \fn atomic_fence
+ * This function orders all memory operations before it with all after it,
+ * stores before it are visible to other threads before loads after it.
+ */
+static inline void atomic_fence(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
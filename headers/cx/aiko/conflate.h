@@ -0,0 +1,137 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_CONFLATE_H_INCLUDED
+#define CX_AIKO_CONFLATE_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "numbers.h"
+#include "kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \def CONFLATE_NONE
+ * This is key, which means that there is no next pending key.
+ */
+#define CONFLATE_NONE MAX_UINT_VALUE
+
+/** \struct conflate_slot_t
+ * This struct store latest value of one key.
+ */
+typedef struct {
+
+    /* This store latest value send with key */
+    void *value;
+
+    /* This store count of values replaced before consumer took them */
+    uint_t coalesced;
+
+    /* This store next pending key, or CONFLATE_NONE */
+    uint_t next;
+
+    /* This is not zero, when value waits for consumer */
+    uint_t pending;
+
+} conflate_slot_t;
+
+/** \struct conflate_t
+ * This struct store conflating mailbox. Each key keeps only latest value,
+ * and consumer process gets only latest values, however fast producers 
+ * send. Values can be send from interrupts, slots are changed by lock free
+ * atomic operations, and consumer is notified by poll of kernel.
+ */
+typedef struct {
+
+    /* This store address of first slot */
+    conflate_slot_t *slots;
+
+    /* This store count of keys */
+    uint_t size;
+
+    /* This store first key taken over by consumer, or CONFLATE_NONE */
+    uint_t head;
+
+    /* This store last key pushed by producers, or CONFLATE_NONE */
+    uint_t pushed;
+
+    /* This store count of all replaced values */
+    uint_t coalesced;
+
+    /* This store poll, which scheduler calls to notify consumer */
+    kernel_poll_t poll;
+
+    /* This store kernel with consumer process */
+    kernel_instance_t *kernel;
+
+    /* This store pid of consumer process */
+    kernel_pid_t pid;
+
+} conflate_t;
+
+/** \fn conflate_create
+ * This create conflating mailbox in given memory. Consumer gets pointer to
+ * mailbox as message, when first of values is pending. Message is send by 
+ * scheduler, from poll which mailbox adds to kernel.
+ * @param *conflate Mailbox to work on
+ * @param *slots Slots, one for each key
+ * @param size Count of keys
+ * @param *kernel Kernel with consumer process
+ * @param pid Pid of consumer process
+ */
+void conflate_create(
+    conflate_t *conflate,
+    conflate_slot_t *slots,
+    uint_t size,
+    kernel_instance_t *kernel,
+    kernel_pid_t pid
+);
+
+/** \fn conflate_send
+ * This send value with key. When previous value of key had not been taken,
+ * it is replaced and counted as coalesced. Value send while consumer takes 
+ * that key can be taken twice, but it is always latest value.
+ * @param *conflate Mailbox to work on
+ * @param key Key of value
+ * @param *value Value to send
+ * @return True if value had been send, false when key is out of mailbox
+ */
+bool conflate_send(conflate_t *conflate, uint_t key, void *value);
+
+/** \fn conflate_take
+ * This take latest value of next pending key, in order in which keys 
+ * became pending. Only consumer process can call it.
+ * @param *conflate Mailbox to work on
+ * @param *key Place to store key
+ * @param **value Place to store value
+ * @param *coalesced Place to store count of replaced values, or NULL
+ * @return True if value had been taken, false when nothing is pending
+ */
+bool conflate_take(
+    conflate_t *conflate,
+    uint_t *key,
+    void **value,
+    uint_t *coalesced
+);
+
+/** \fn conflate_is_pending
+ * This check if any of values waits for consumer.
+ * @param *conflate Mailbox to work on
+ * @return True if any of values is pending, false if not
+ */
+bool conflate_is_pending(conflate_t *conflate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_DEFERRED_H_INCLUDED
+#define CX_AIKO_DEFERRED_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "numbers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \def MAX_DEFERRED_SIZE
+ * This define max count of entries in deferred queue.
+ */
+#ifndef AIKO_SHORT_NUMBERS
+#define MAX_DEFERRED_SIZE 0x4000
+#else
+#define MAX_DEFERRED_SIZE 0x40
+#endif
+
+/** \typedef deferred_function_t
+ * This is type of function posted to deferred queue. First parameter is 
+ * kernel instance, second is argument given when posting.
+ */
+typedef void (*deferred_function_t)(void *, void *);
+
+/** \typedef deferred_wake_t
+ * This is type of function, which wakes consumer up after work is posted.
+ * Parameter is argument given when wake function had been set.
+ */
+typedef void (*deferred_wake_t)(void *);
+
+/** \struct deferred_waker_t
+ * This struct store wake function with its argument. Queue points to it by
+ * one pointer, so poster never sees function without its argument.
+ */
+typedef struct {
+
+    /* This store function, which wakes consumer up */
+    deferred_wake_t wake;
+
+    /* This store argument of wake function */
+    void *sleeper;
+
+} deferred_waker_t;
+
+/** \struct deferred_entry_t
+ * This struct store one work posted to deferred queue. When function is 
+ * NULL, argument is message to send into process with pid.
+ */
+typedef struct {
+
+    /* This store sequence number, which tells who own entry now */
+    uint_t sequence;
+
+    /* This store pid of process to send message */
+    uint_t pid;
+
+    /* This store function to call, or NULL */
+    deferred_function_t function;
+
+    /* This store argument of function, or message to send */
+    void *argument;
+
+} deferred_entry_t;
+
+/** \struct deferred_t
+ * This struct store bounded queue, to which interrupts can post work. Many
+ * interrupts or signal handlers can post, only scheduler takes work out.
+ */
+typedef struct {
+
+    /* This store address of first entry */
+    deferred_entry_t *entries;
+
+    /* This store count of entries minus one, count is power of two */
+    uint_t mask;
+
+    /* This store position of next entry to take out */
+    uint_t head;
+
+    /* This store position of next entry to post */
+    uint_t tail;
+
+    /* This store pointer to deferred_waker_t of consumer, or NULL */
+    void *waker;
+
+    /* This store count of wake functions, which are running now */
+    uint_t waking;
+
+} deferred_t;
+
+/** \fn deferred_create
+ * This prepare deferred queue to work.
+ * @param *queue Queue to work on
+ * @param *entries Static table of entries
+ * @param size Count of entries, rounded down to power of two
+ */
+void deferred_create(
+    deferred_t *queue, 
+    deferred_entry_t *entries, 
+    uint_t size
+);
+
+/** \fn deferred_set_wake
+ * This set waker, which is called after each post, to wake consumer up
+ * when it sleeps. It can be changed while other threads post. It returns 
+ * when wake functions of previous waker had ended, so its sleeper can be
+ * freed. It must not be called from interrupt.
+ * @param *queue Queue to work on
+ * @param *waker Waker to call, or NULL
+ */
+void deferred_set_wake(deferred_t *queue, deferred_waker_t *waker);
+
+/** \fn deferred_wake
+ * This call wake function of queue, when it is set. It is called after 
+ * each post, and can be called when interrupt gives work to consumer by 
+ * other way.
+ * @param *queue Queue to work on
+ */
+void deferred_wake(deferred_t *queue);
+
+/** \fn deferred_post_message
+ * This post message, which scheduler would send to process with given pid.
+ * It is safe to call it from interrupts. Then it wakes consumer up.
+ * @param *queue Queue to work on
+ * @param pid Pid of process to send
+ * @param *message Message to send
+ * @return True if message had been posted, false if queue is full
+ */
+bool deferred_post_message(deferred_t *queue, uint_t pid, void *message);
+
+/** \fn deferred_post_function
+ * This post function, which scheduler would call with given argument. It is
+ * safe to call it from interrupts. Then it wakes consumer up.
+ * @param *queue Queue to work on
+ * @param function Function to call
+ * @param *argument Argument of function
+ * @return True if function had been posted, false if queue is full
+ */
+bool deferred_post_function(
+    deferred_t *queue, 
+    deferred_function_t function, 
+    void *argument
+);
+
+/** \fn deferred_peek
+ * This return first posted entry, without taking it out. Only one consumer
+ * can take entries out of queue.
+ * @param *queue Queue to work on
+ * @return First entry, or NULL when queue is empty
+ */
+deferred_entry_t* deferred_peek(deferred_t *queue);
+
+/** \fn deferred_pop
+ * This take out first entry, returned by deferred_peek.
+ * @param *queue Queue to work on
+ */
+void deferred_pop(deferred_t *queue);
+
+/** \fn deferred_requeue
+ * This move first entry, returned by deferred_peek, to end of queue. Only 
+ * consumer can call it.
+ * @param *queue Queue to work on
+ * @return True if entry had been moved, false if queue is full
+ */
+bool deferred_requeue(deferred_t *queue);
+
+/** \fn deferred_count
+ * This return count of entries posted to queue and not taken out yet, it 
+ * counts entries which are still being posted too.
+ * @param *queue Queue to work on
+ * @return Count of entries
+ */
+uint_t deferred_count(deferred_t *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
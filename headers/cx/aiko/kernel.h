@@ -11,15 +11,28 @@
 #ifndef CX_AIKO_KERNEL_H_INCLUDED
 #define CX_AIKO_KERNEL_H_INCLUDED
 
+#include <stdint.h>
 #include "process.h"
 #include "message_box.h"
 #include "numbers.h"
+#include "deferred.h"
+#include "task.h"
+#include "latency.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /** \typedef pid_t 
  * This type store process id in system.
  */
 typedef uint_t kernel_pid_t;
 
+/** \typedef kernel_time_t
+ * This type store time from kernel clock, unit of time is unit of clock.
+ */
+typedef uint32_t kernel_time_t;
+
 /** \def MAX_PID_VALUE
  * This define max value of pid that can be used.
  */
@@ -30,6 +43,136 @@ typedef uint_t kernel_pid_t;
  */
 #define ERROR_PID MAX_UINT_VALUE
 
+/** \def AIKO_SEGMENTED_KERNEL
+ * With this switch kernel can be created by kernel_create_segmented, then 
+ * its process table grows in segments on demand. Kernel also stores pid 
+ * after last living process, and scheduler stops there. Without it, kernel
+ * does not store segments, and code of growing is not linked with static 
+ * kernels.
+ */
+#ifdef AIKO_SEGMENTED_KERNEL
+
+/** \def MAX_SEGMENT_SIZE
+ * This define max count of processes in one segment of segmented kernel.
+ */
+#ifndef AIKO_SHORT_NUMBERS
+#define MAX_SEGMENT_SIZE 0x8000
+#else
+#define MAX_SEGMENT_SIZE 0x80
+#endif
+
+/** \def KERNEL_USED
+ * This return pid after last living process of kernel.
+ */
+#define KERNEL_USED(kernel) ((kernel)->used)
+
+#else
+
+#define KERNEL_USED(kernel) ((kernel)->size)
+
+#endif
+
+#ifdef AIKO_MESSAGE_PAYLOAD_SIZE
+
+/** \def KERNEL_PROCESS_MESSAGE_BOX_SEND_TYPED
+ * This send value of given type by value into message box of process with
+ * given pid. When type does not fit in payload, it would not compile.
+ * @param kernel Kernel instance to work on
+ * @param pid Pid of process to send
+ * @param type Type of value
+ * @param value Value to send
+ */
+#define KERNEL_PROCESS_MESSAGE_BOX_SEND_TYPED(kernel, pid, type, value) do { \
+    type kernel_value = (value); \
+    (void)sizeof(char[sizeof(type) <= AIKO_MESSAGE_PAYLOAD_SIZE ? 1 : -1]); \
+    kernel_process_message_box_send_value( \
+        (kernel), (pid), &kernel_value, sizeof(type) \
+    ); \
+} while (0)
+
+#endif
+
+/** \struct kernel_handle_t
+ * This struct store handle of process, which is checked once, when it is 
+ * got. It becomes invalid, when process is killed.
+ */
+typedef struct {
+
+    /* This store process, or NULL when handle is not valid */
+    process_t *process;
+
+    /* This store generation of process, when handle had been got */
+    uint8_t generation;
+
+} kernel_handle_t;
+
+/** \def AIKO_DEBUG
+ * Each operation on handle checks that handle is not NULL, compares 
+ * generation of handle and process, and does nothing when process had been
+ * killed or created again. With this switch, it also checks that process 
+ * is living.
+ */
+#ifdef AIKO_DEBUG
+#define KERNEL_HANDLE_CHECK(handle, result) \
+    if (!kernel_handle_is_valid(handle)) return result
+#else
+#define KERNEL_HANDLE_CHECK(handle, result) \
+    if ( \
+        (handle).process == NULL || \
+        PROCESS_GET_GENERATION((handle).process) != (handle).generation \
+    ) return result
+#endif
+
+#ifdef AIKO_STATISTICS
+
+/** \struct kernel_statistics_t
+ * This struct store statistics of scheduler, collected when library is 
+ * compiled with AIKO_STATISTICS. Counters wrap, so they should be read and
+ * reset in windows.
+ */
+typedef struct {
+
+    /* This store count of scheduler loops */
+    uint32_t passes;
+
+    /* This store count of loops, which did not execute any process */
+    uint32_t idle_passes;
+
+    /* This store count of executed processes */
+    uint32_t dispatches;
+
+    /* This store time of loops, which executed any process */
+    kernel_time_t busy;
+
+    /* This store time from reset of statistics to read of them */
+    kernel_time_t window;
+
+} kernel_statistics_t;
+
+#endif
+
+/** \struct kernel_poll_t
+ * This struct store work, which interrupts request by setting flag, so 
+ * request can not be lost like post into full deferred queue. Requested 
+ * function is called once by scheduler, however many times it had been 
+ * requested.
+ */
+typedef struct kernel_poll_s {
+
+    /* This store function to call, with kernel and argument */
+    deferred_function_t function;
+
+    /* This store argument of function */
+    void *argument;
+
+    /* This is not zero, when function had been requested */
+    uint_t requested;
+
+    /* This store next poll of kernel, or NULL */
+    struct kernel_poll_s *next;
+
+} kernel_poll_t;
+
 /** \struct kernel_instance_t
  * This struct store instance of kernel in system.
  */
@@ -37,6 +180,11 @@ typedef struct {
     
     /* This store address to first element of processes array */
     process_t *processes;
+
+#ifdef AIKO_SEGMENTED_KERNEL
+    /* This store segments of growable kernel, or NULL for flat kernel */
+    process_t **segments;
+#endif
     
     /* This store size of processes array */
     kernel_pid_t size;
@@ -44,6 +192,45 @@ typedef struct {
     /* This store process that will be executed next */
     kernel_pid_t last_changed;
 
+    /* This store pid, from which next loop continues after limit stop it */
+    kernel_pid_t cursor;
+
+#ifdef AIKO_SEGMENTED_KERNEL
+    /* This store pid after last living process, scheduler stop there */
+    kernel_pid_t used;
+
+    /* This store log2 of segment size in segmented kernel */
+    uint_t segment_shift;
+#endif
+
+    /* This store queue of work posted by interrupts, or NULL */
+    deferred_t *deferred;
+
+    /* This store first poll, which interrupts can request, or NULL */
+    kernel_poll_t *polls;
+
+    /* This store pool of tasks posted by kernel_post, or NULL */
+    task_pool_t *tasks;
+
+    /* This store function, which return current time, or NULL */
+    kernel_time_t (*clock)(void);
+
+#ifdef AIKO_LATENCY
+    /* This store histograms of latency, one for each pid, or NULL */
+    latency_histogram_t *latency;
+
+    /* This store count of histograms */
+    kernel_pid_t latency_size;
+#endif
+
+#ifdef AIKO_STATISTICS
+    /* This store statistics of scheduler, window field is not used */
+    kernel_statistics_t statistics;
+
+    /* This store time from kernel clock, when statistics had been reset */
+    kernel_time_t statistics_start;
+#endif
+
 } kernel_instance_t;
 
 /** \fn kernel_create 
@@ -65,6 +252,37 @@ void kernel_create_static(
     uint_t size
 );
 
+#ifdef AIKO_SEGMENTED_KERNEL
+
+/** \fn kernel_create_segmented
+ * This create kernel, which process table grows in segments on demand. 
+ * Segments are never moved, so process_t pointers stay valid until process
+ * segment is released by kernel_shrink.
+ * @param *kernel Kernel instance to work on
+ * @param segment_size Count of processes in one segment, rounded up to power
+ *                     of two
+ */
+void kernel_create_segmented(kernel_instance_t *kernel, uint_t segment_size);
+
+/** \fn kernel_grow
+ * This function add new segment to segmented kernel.
+ * @param *kernel Kernel instance to work on
+ * @return True if kernel had been grown, false if not
+ */
+bool kernel_grow(kernel_instance_t *kernel);
+
+/** \fn kernel_shrink
+ * This function release empty segments from end of segmented kernel. First
+ * segment is never released. When kernel has not any segment, because 
+ * first of them could not be allocated, directory of segments is released,
+ * and kernel can only be removed. Call it only outside of scheduler, when 
+ * no one use process_t pointers to released processes.
+ * @param *kernel Kernel instance to work on
+ */
+void kernel_shrink(kernel_instance_t *kernel);
+
+#endif
+
 /** \fn kernel_remove
  * This function remove kernel instance and dealocate memory.
  * @param *kernel Kernel instance to work on
@@ -84,6 +302,210 @@ void kernel_remove_static(kernel_instance_t *kernel);
  */
 void kernel_scheduler(kernel_instance_t *kernel);
 
+/** \fn kernel_run_once
+ * This run one loop of scheduler and return. It can be used to run kernel 
+ * from event loop of other system.
+ * @param *kernel Kernel instance to work on
+ * @return True if there is still work to do, false if kernel is idle
+ */
+bool kernel_run_once(kernel_instance_t *kernel);
+
+/** \fn kernel_run_pass
+ * This run exactly one loop of scheduler, like kernel_run_once, but does 
+ * not check if there is still work to do after it.
+ * @param *kernel Kernel instance to work on
+ * @return Count of executed processes
+ */
+uint_t kernel_run_pass(kernel_instance_t *kernel);
+
+/** \fn kernel_run_for
+ * This run scheduler until given count of processes had been executed, or
+ * until kernel is idle. When limit stops loop, next call continues from 
+ * process after last executed one.
+ * @param *kernel Kernel instance to work on
+ * @param dispatches Max count of processes to execute
+ * @return Count of executed processes
+ */
+uint_t kernel_run_for(kernel_instance_t *kernel, uint_t dispatches);
+
+/** \fn kernel_run_until
+ * This run scheduler until kernel clock reach deadline, or until kernel is
+ * idle. Without clock it run one loop.
+ * @param *kernel Kernel instance to work on
+ * @param deadline Time from kernel clock, when it should return
+ * @return Count of executed processes
+ */
+uint_t kernel_run_until(kernel_instance_t *kernel, kernel_time_t deadline);
+
+/** \fn kernel_next_ready
+ * This return pid of process, which would be executed first by scheduler.
+ * It checks marked process, then continues from cursor to end of table 
+ * and wraps around to its begin, like scheduler does. Pending tasks run
+ * in the wrapped part, before processes with pids not lower than their 
+ * priority, so task can run before returned process. kernel_has_work 
+ * checks pending tasks too.
+ * @param *kernel Kernel instance to work on
+ * @return Pid of first ready process, or ERROR_PID when there is not any
+ */
+kernel_pid_t kernel_next_ready(kernel_instance_t *kernel);
+
+/** \fn kernel_has_work
+ * This check if scheduler has any work to do now, any process is ready,
+ * any work waits in deferred queue or any poll is requested.
+ * @param *kernel Kernel instance to work on
+ * @return True if kernel has work, false when it is idle
+ */
+bool kernel_has_work(kernel_instance_t *kernel);
+
+/** \fn kernel_set_clock
+ * This set clock of kernel, which is used by kernel_run_until.
+ * @param *kernel Kernel instance to work on
+ * @param (*clock)(void) Function, which return current time, or NULL
+ */
+void kernel_set_clock(
+    kernel_instance_t *kernel, 
+    kernel_time_t (*clock)(void)
+);
+
+#ifdef AIKO_LATENCY
+
+/** \fn kernel_set_latency
+ * This set histograms of latency, histogram index is pid of process. 
+ * Kernel must have clock, messages are stamped with it when they are send.
+ * @param *kernel Kernel instance to work on
+ * @param *histograms First of histograms, or NULL to stop recording
+ * @param count Count of histograms
+ */
+void kernel_set_latency(
+    kernel_instance_t *kernel,
+    latency_histogram_t *histograms,
+    kernel_pid_t count
+);
+
+/** \fn kernel_record_latency
+ * This record latency of message in box of process, when it is stamped. 
+ * Scheduler calls it before each process, other schedulers must call it
+ * too.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process, which is going to be executed
+ */
+void kernel_record_latency(
+    kernel_instance_t *kernel, 
+    kernel_pid_t process_pid
+);
+
+#endif
+
+#ifdef AIKO_STATISTICS
+
+/** \fn kernel_reset_statistics
+ * This clear statistics of scheduler and start new window of them. Kernel 
+ * clock is used to measure time, kernel_set_clock resets statistics too.
+ * @param *kernel Kernel instance to work on
+ */
+void kernel_reset_statistics(kernel_instance_t *kernel);
+
+/** \fn kernel_get_statistics
+ * This copy statistics of scheduler from last reset. Without kernel clock,
+ * busy and window are zero.
+ * @param *kernel Kernel instance to work on
+ * @param *statistics Place to copy statistics into
+ */
+void kernel_get_statistics(
+    kernel_instance_t *kernel,
+    kernel_statistics_t *statistics
+);
+
+/** \fn kernel_load
+ * This return load of scheduler in percents, as part of window, when it was
+ * busy. Without time, it is part of loops, which executed any process.
+ * @param *statistics Statistics to work on
+ * @return Load from 0 to 100
+ */
+uint_t kernel_load(const kernel_statistics_t *statistics);
+
+/** \fn kernel_record_pass
+ * This add one loop of scheduler into statistics. Scheduler calls it after
+ * each loop, other schedulers must call it too.
+ * @param *kernel Kernel instance to work on
+ * @param start Time from kernel clock, when loop started, or zero
+ * @param dispatched Count of processes executed in loop
+ */
+void kernel_record_pass(
+    kernel_instance_t *kernel,
+    kernel_time_t start,
+    uint_t dispatched
+);
+
+#endif
+
+/** \fn kernel_set_tasks
+ * This set pool of tasks, which can be posted by kernel_post.
+ * @param *kernel Kernel instance to work on
+ * @param *pool Pool of tasks, or NULL to remove it
+ */
+void kernel_set_tasks(kernel_instance_t *kernel, task_pool_t *pool);
+
+/** \fn kernel_post
+ * This post function, which would be called once by scheduler, in next 
+ * loop before process with priority pid. Task does not need pid, and it is
+ * returned into pool before function is called.
+ * @param *kernel Kernel instance to work on
+ * @param function Function to call, with kernel and argument
+ * @param *argument Argument of function
+ * @param priority Pid of process, before which task runs, or TASK_LAST
+ * @return True if task had been posted, false when pool is empty
+ */
+bool kernel_post(
+    kernel_instance_t *kernel,
+    task_function_t function,
+    void *argument,
+    kernel_pid_t priority
+);
+
+/** \fn kernel_set_deferred
+ * This set queue, to which interrupts can post work for kernel. Scheduler 
+ * takes work out of it on begin of each loop.
+ * @param *kernel Kernel instance to work on
+ * @param *queue Deferred queue, or NULL to remove it
+ */
+void kernel_set_deferred(kernel_instance_t *kernel, deferred_t *queue);
+
+/** \fn kernel_add_poll
+ * This add poll to kernel. Call it before interrupts can request it.
+ * @param *kernel Kernel instance to work on
+ * @param *poll Poll to add, it must live as long as kernel
+ * @param function Function to call, with kernel and argument
+ * @param *argument Argument of function
+ */
+void kernel_add_poll(
+    kernel_instance_t *kernel,
+    kernel_poll_t *poll,
+    deferred_function_t function,
+    void *argument
+);
+
+/** \fn kernel_request_poll
+ * This request call of poll function in next loop of scheduler, and wakes
+ * scheduler up by deferred queue, when it has one. It is safe to call it 
+ * from interrupts.
+ * @param *kernel Kernel instance to work on
+ * @param *poll Poll to request
+ */
+void kernel_request_poll(kernel_instance_t *kernel, kernel_poll_t *poll);
+
+/** \fn kernel_deferred_drain
+ * This do work posted to deferred queue, each entry once, and then calls 
+ * requested polls. Messages for pid out of table, or for empty process, 
+ * are dropped. When message box of process is full, message is moved to 
+ * end of queue, so it waits for next call, and messages for other 
+ * processes are not blocked. Messages for one process are send in order 
+ * they was posted. Scheduler call it, so call it only when You run 
+ * processes without kernel_scheduler.
+ * @param *kernel Kernel instance to work on
+ */
+void kernel_deferred_drain(kernel_instance_t *kernel);
+
 /** \fn kernel_get_empty_pid
  * This function search and return first empty pid in array.
  * @param *kernel Kernel instance to work on
@@ -91,6 +513,17 @@ void kernel_scheduler(kernel_instance_t *kernel);
  */
 kernel_pid_t kernel_get_empty_pid(kernel_instance_t *kernel);
 
+/** \fn kernel_get_process
+ * This function return process with given pid.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process to get
+ * @return Process with given pid, or NULL when pid is out of table
+ */
+process_t* kernel_get_process(
+    kernel_instance_t *kernel, 
+    kernel_pid_t process_pid
+);
+
 /** \fn kernel_trigger_signal
  * This function trigger signal in operating system.
  * @param *kernel Kernel instance to work on
@@ -107,15 +540,83 @@ void kernel_trigger_signal(kernel_instance_t *kernel, uintptr_t signal);
  */
 void kernel_sum_signal(kernel_instance_t *kernel, uintptr_t new_signal);
  
+/** \fn kernel_get_handle
+ * This check pid once, and return handle of process with it. Handle can be
+ * used to send messages without checking pid again.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process
+ * @return Handle of process, with NULL process when pid is not living
+ */
+kernel_handle_t kernel_get_handle(
+    kernel_instance_t *kernel, 
+    kernel_pid_t process_pid
+);
+
+/** \fn kernel_handle_is_valid
+ * This check if process of handle is still living. After kernel_shrink, 
+ * handles of released processes must not be used.
+ * @param handle Handle to check
+ * @return True if handle is valid, false if not
+ */
+static inline bool kernel_handle_is_valid(kernel_handle_t handle) {
+    if (handle.process == NULL) return false;
+    if (PROCESS_GET_TYPE(handle.process) == EMPTY) return false;
+
+    return PROCESS_GET_GENERATION(handle.process) == handle.generation;
+}
+
+/** \fn kernel_handle_is_sendable
+ * This check if message box of process is ready to receive new data.
+ * @param handle Handle of process
+ * @return This return process message box state
+ */
+static inline bool kernel_handle_is_sendable(kernel_handle_t handle) {
+    KERNEL_HANDLE_CHECK(handle, false);
+
+    return !MESSAGE_BOX_IS_READABLE(handle.process->message);
+}
+
+/** \fn kernel_handle_send
+ * This send message to process.
+ * @param handle Handle of process
+ * @param *message Message to send
+ */
+static inline void kernel_handle_send(kernel_handle_t handle, void *message) {
+    KERNEL_HANDLE_CHECK(handle, );
+
+    handle.process->message->message = message;
+
+#ifdef AIKO_LATENCY
+    handle.process->message->stamp = MESSAGE_BOX_NO_STAMP;
+#endif
+
+    MESSAGE_BOX_RELEASE();
+    MESSAGE_BOX_SET_READABLE(handle.process->message);
+}
+
+/** \fn kernel_handle_show
+ * This return message from message box of process, without removing it.
+ * @param handle Handle of process
+ * @return Message from message box
+ */
+static inline void* kernel_handle_show(kernel_handle_t handle) {
+    KERNEL_HANDLE_CHECK(handle, NULL);
+
+    return handle.process->message->message;
+}
+
 /** \fn kernel_create_process
- * This will create new process in system from given params.
+ * This will create new process in system from given params. When process 
+ * with that pid is living, its handles become invalid.
  * @param *kernel Kernel instance to work on
  * @param process_pid Pid of new process
  * @param type Type of new process
  * @param (*worker)(...) Process worker, process main function
  * @param *parameter Parameter to worker
+ * @return True if process had been created, false when pid is out of table
+ *         or worker is not in PROCESS_WORKERS, then pid is not changed
  */
-void kernel_create_process(
+bool kernel_create_process(
     kernel_instance_t *kernel,
     kernel_pid_t process_pid,
     process_type_t type,
@@ -156,6 +657,25 @@ void kernel_process_message_box_send(
     void *message
 );
 
+#ifdef AIKO_MESSAGE_PAYLOAD_SIZE
+
+/** \fn kernel_process_message_box_send_value
+ * This function copy data into payload of message box of process with given
+ * pid, and send it.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process to send
+ * @param *data Data to copy
+ * @param size Size of data in bytes
+ */
+void kernel_process_message_box_send_value(
+    kernel_instance_t *kernel,
+    kernel_pid_t process_pid,
+    const void *data,
+    size_t size
+);
+
+#endif
+
 /** \fn kernel_process_message_box_show
  * This function show value in message box for process which have specified 
  * process id
@@ -168,4 +688,8 @@ void* kernel_process_message_box_show(
     kernel_pid_t process_pid
 );
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
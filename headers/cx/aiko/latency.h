@@ -0,0 +1,103 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_LATENCY_H_INCLUDED
+#define CX_AIKO_LATENCY_H_INCLUDED
+
+#include <stdint.h>
+#include <stdio.h>
+#include "numbers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \def AIKO_LATENCY
+ * With this switch, kernel stores time of send in message box, and when 
+ * process is executed, adds time which message waited into histogram of 
+ * process. Kernel must have clock and histograms.
+ */
+
+/** \def AIKO_LATENCY_BUCKETS
+ * This is count of buckets in histogram. Bucket n store times with n bits,
+ * last bucket store also all of longer times.
+ */
+#ifndef AIKO_LATENCY_BUCKETS
+#ifndef AIKO_SHORT_NUMBERS
+#define AIKO_LATENCY_BUCKETS 32
+#else
+#define AIKO_LATENCY_BUCKETS 16
+#endif
+#endif
+
+/** \struct latency_histogram_t
+ * This struct store histogram of latency with fixed size. When bucket is 
+ * full, all of buckets are halved, so shape of histogram is kept.
+ */
+typedef struct {
+
+    /* This store count of times in each bucket */
+    uint16_t buckets[AIKO_LATENCY_BUCKETS];
+
+    /* This store longest time */
+    uint32_t max;
+
+} latency_histogram_t;
+
+/** \fn latency_reset
+ * This clear histograms.
+ * @param *histograms First of histograms
+ * @param count Count of histograms
+ */
+void latency_reset(latency_histogram_t *histograms, uint_t count);
+
+/** \fn latency_record
+ * This add time to histogram.
+ * @param *histogram Histogram to work on
+ * @param time Time which message waited, in units of kernel clock
+ */
+void latency_record(latency_histogram_t *histogram, uint32_t time);
+
+/** \fn latency_count
+ * This return count of times in histogram.
+ * @param *histogram Histogram to work on
+ * @return Count of times
+ */
+uint32_t latency_count(const latency_histogram_t *histogram);
+
+/** \fn latency_percentile
+ * This return time, which is not exceeded by given percent of messages. It
+ * is upper bound of bucket, so it can be up to two times too big.
+ * @param *histogram Histogram to work on
+ * @param percent Percent, from 0 to 100
+ * @return Time in units of kernel clock
+ */
+uint32_t latency_percentile(
+    const latency_histogram_t *histogram, 
+    uint8_t percent
+);
+
+/** \fn latency_dump
+ * This print p50, p99 and max of each histogram with any of times.
+ * @param *stream Stream to print into
+ * @param *histograms First of histograms, histogram index is pid
+ * @param count Count of histograms
+ */
+void latency_dump(
+    FILE *stream, 
+    const latency_histogram_t *histograms, 
+    uint_t count
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
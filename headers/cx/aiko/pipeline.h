@@ -0,0 +1,206 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_PIPELINE_H_INCLUDED
+#define CX_AIKO_PIPELINE_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "numbers.h"
+#include "process.h"
+#include "kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef AIKO_NO_PROCESS_PARAMETER
+#error "Pipeline requires process parameter, remove AIKO_NO_PROCESS_PARAMETER"
+#endif
+
+/** \def PIPELINE_MAX_OUTPUTS
+ * This define max count of stages, to which one stage can emit items. You
+ * can change it by -DPIPELINE_MAX_OUTPUTS=N for library and project.
+ */
+#ifndef PIPELINE_MAX_OUTPUTS
+#define PIPELINE_MAX_OUTPUTS 2
+#endif
+
+/** \def PIPELINE_ERROR
+ * This is returned instead of stage index, when stage can not be added.
+ */
+#define PIPELINE_ERROR MAX_UINT_VALUE
+
+/** \struct pipeline_stage_t
+ * This struct store one stage of pipeline. Stage is REACTIVE process with 
+ * bounded queue of items before it. Stage is dispatched only when all of
+ * its outputs have place for item, which it emits.
+ */
+typedef struct {
+
+    /* This store stage function, it gets stage and item */
+    void (*function)(void *, void *);
+
+    /* This store parameter for stage function */
+    void *parameter;
+
+    /* This store pipeline, which stage belongs to */
+    void *pipeline;
+
+    /* This store address of first element of queue */
+    void **queue;
+
+    /* This store size of queue */
+    uint_t capacity;
+
+    /* This store position of first item in queue */
+    uint_t head;
+
+    /* This store count of items in queue */
+    uint_t depth;
+
+    /* This store max count of items, which had been in queue */
+    uint_t max_depth;
+
+    /* This store count of places in queue, reserved by dispatched stages */
+    uint_t reserved;
+
+    /* This store indexes of stages, to which stage emits items */
+    uint_t outputs[PIPELINE_MAX_OUTPUTS];
+
+    /* This store count of outputs */
+    uint_t outputs_count;
+
+    /* This store position of stage in topological order */
+    uint_t order;
+
+    /* True when stage had reserved place in outputs for its item */
+    bool holding;
+
+    /* This store pid of stage process */
+    kernel_pid_t pid;
+
+} pipeline_stage_t;
+
+/** \struct pipeline_t
+ * This struct store pipeline, stages connected into directed graph without
+ * cycles.
+ */
+typedef struct {
+
+    /* This store kernel, in which stages are running */
+    kernel_instance_t *kernel;
+
+    /* This store address of first element of stages array */
+    pipeline_stage_t *stages;
+
+    /* This store size of stages array */
+    uint_t size;
+
+    /* This store count of added stages */
+    uint_t count;
+
+} pipeline_t;
+
+/** \fn pipeline_create
+ * This prepare new pipeline to work.
+ * @param *pipeline Pipeline to work on
+ * @param *kernel Kernel, in which stages would be running
+ * @param *stages Static stages array
+ * @param size Size of stages array
+ */
+void pipeline_create(
+    pipeline_t *pipeline,
+    kernel_instance_t *kernel,
+    pipeline_stage_t *stages,
+    uint_t size
+);
+
+/** \fn pipeline_add_stage
+ * This add new stage to pipeline. Stage function gets stage and item, and
+ * can emit new items by pipeline_emit.
+ * @param *pipeline Pipeline to work on
+ * @param (*function)(...) Stage function
+ * @param *parameter Parameter for stage function
+ * @param **queue Static queue array
+ * @param capacity Size of queue array
+ * @return Index of new stage, or PIPELINE_ERROR
+ */
+uint_t pipeline_add_stage(
+    pipeline_t *pipeline,
+    void (*function)(pipeline_stage_t *, void *),
+    void *parameter,
+    void **queue,
+    uint_t capacity
+);
+
+/** \fn pipeline_connect
+ * This connect output of one stage, with input of other stage.
+ * @param *pipeline Pipeline to work on
+ * @param from Index of stage, which emits items
+ * @param to Index of stage, which receives items
+ * @return True if stages had been connected, false if not
+ */
+bool pipeline_connect(pipeline_t *pipeline, uint_t from, uint_t to);
+
+/** \fn pipeline_start
+ * This create processes for all stages. Stages get pids in topological 
+ * order, so when more stages are ready, scheduler runs earlier first.
+ * @param *pipeline Pipeline to work on
+ * @return True if pipeline had been started, false on cycle or no pids,
+ * then none of stages is left running
+ */
+bool pipeline_start(pipeline_t *pipeline);
+
+/** \fn pipeline_get_stage
+ * This return stage with given index.
+ * @param *pipeline Pipeline to work on
+ * @param stage Index of stage
+ * @return Stage, or NULL if it does not exists
+ */
+pipeline_stage_t* pipeline_get_stage(pipeline_t *pipeline, uint_t stage);
+
+/** \fn pipeline_push
+ * This push item into queue of stage, for example from source of data.
+ * @param *stage Stage to work on
+ * @param *item Item to push
+ * @return True if item had been pushed, false when queue is full
+ */
+bool pipeline_push(pipeline_stage_t *stage, void *item);
+
+/** \fn pipeline_emit
+ * This push item into queues of all outputs of stage. When it is called 
+ * once in stage function, there is always place for item.
+ * @param *stage Stage to work on
+ * @param *item Item to emit
+ * @return True if item had been emitted, false when any output is full
+ */
+bool pipeline_emit(pipeline_stage_t *stage, void *item);
+
+/** \fn pipeline_stage_depth
+ * This return count of items, waiting in queue of stage.
+ * @param *stage Stage to work on
+ * @return Count of items in queue
+ */
+uint_t pipeline_stage_depth(pipeline_stage_t *stage);
+
+/** \fn pipeline_stage_worker
+ * This is worker of all stage processes. With AIKO_COMPACT_PROCESS it must
+ * be in process_workers table.
+ * @param *kernel Kernel instance
+ * @param *process Stage process
+ */
+void pipeline_stage_worker(kernel_instance_t *kernel, process_t *process);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
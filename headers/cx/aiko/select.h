@@ -0,0 +1,132 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_SELECT_H_INCLUDED
+#define CX_AIKO_SELECT_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "numbers.h"
+#include "message_box.h"
+#include "kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \def SELECT_ANY
+ * This is condition, which holds when any of channels has message.
+ */
+#define SELECT_ANY 0x01
+
+/** \def SELECT_ALL
+ * This is condition, which holds when all of channels have messages.
+ */
+#define SELECT_ALL MAX_UINT_VALUE
+
+/** \struct select_t
+ * This struct store set of input channels of one process. Each channel is
+ * message box, and process is executed only when enough of them have 
+ * messages.
+ */
+typedef struct {
+
+    /* This store address of first channel */
+    message_box_t *channels;
+
+    /* This store count of channels */
+    uint_t size;
+
+    /* This store count of channels, which must have messages */
+    uint_t threshold;
+
+    /* This store count of channels, which have messages */
+    uint_t ready;
+
+    /* This store kernel with process */
+    kernel_instance_t *kernel;
+
+    /* This store pid of process */
+    kernel_pid_t pid;
+
+    /* This store poll, which scheduler calls to notify process */
+    kernel_poll_t poll;
+
+} select_t;
+
+/** \fn select_create
+ * This create set of channels for process. Process gets pointer to set as
+ * message, when condition holds. Set adds its poll to kernel.
+ * @param *select Set to work on
+ * @param *channels Message boxes, one for each channel
+ * @param size Count of channels
+ * @param threshold SELECT_ANY, SELECT_ALL, or count of channels
+ * @param *kernel Kernel with process
+ * @param pid Pid of process
+ */
+void select_create(
+    select_t *select,
+    message_box_t *channels,
+    uint_t size,
+    uint_t threshold,
+    kernel_instance_t *kernel,
+    kernel_pid_t pid
+);
+
+/** \fn select_is_sendable
+ * This check if message can be send into channel.
+ * @param *select Set to work on
+ * @param channel Index of channel
+ * @return True if channel is empty, false if not
+ */
+bool select_is_sendable(select_t *select, uint_t channel);
+
+/** \fn select_send
+ * This send message into channel. When condition holds, it requests poll
+ * of set, and scheduler notifies process in its next loop.
+ * @param *select Set to work on
+ * @param channel Index of channel
+ * @param *message Message to send
+ * @return True if message had been send, false when channel is full
+ */
+bool select_send(select_t *select, uint_t channel, void *message);
+
+/** \fn select_is_ready
+ * This check if condition of set holds.
+ * @param *select Set to work on
+ * @return True if enough of channels have messages, false if not
+ */
+bool select_is_ready(select_t *select);
+
+/** \fn select_take
+ * This take message from one channel. When condition does not hold after
+ * that, set which waits in message box of process is removed.
+ * @param *select Set to work on
+ * @param channel Index of channel
+ * @param **message Place to store message
+ * @return True if message had been taken, false when channel is empty
+ */
+bool select_take(select_t *select, uint_t channel, void **message);
+
+/** \fn select_take_all
+ * This take messages from all of channels at once. Empty channels give 
+ * NULL. Set which waits in message box of process is removed, so process 
+ * is not executed again before condition holds.
+ * @param *select Set to work on
+ * @param **messages Place to store messages, one for each channel
+ * @return Count of taken messages
+ */
+uint_t select_take_all(select_t *select, void **messages);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
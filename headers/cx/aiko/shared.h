@@ -0,0 +1,227 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_SHARED_H_INCLUDED
+#define CX_AIKO_SHARED_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "numbers.h"
+#include "kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \def SHARED_ERROR
+ * This is returned instead of box index or block index on error.
+ */
+#define SHARED_ERROR UINT32_MAX
+
+/** \struct shared_header_t
+ * This struct is on begin of shared memory region.
+ */
+typedef struct {
+
+    /* This store magic number, set when region is ready */
+    uint32_t magic;
+
+    /* This store count of message boxes */
+    uint32_t boxes;
+
+    /* This store count of blocks in pool */
+    uint32_t blocks;
+
+    /* This store size of one block in bytes */
+    uint32_t block_size;
+
+    /* This store counter, which is increased by each send */
+    uint32_t doorbell;
+
+    /* This store count of processes, which wait on doorbell */
+    uint32_t sleepers;
+
+    /* This store first free block, and tag against ABA in high half */
+    uint64_t free;
+
+} shared_header_t;
+
+/** \struct shared_box_t
+ * This struct store message box in shared memory. Message is index of block
+ * from pool, so it is valid in each process, which maps region. Only one 
+ * process can send into one box in same time.
+ */
+typedef struct {
+
+    /* This store 1 when box is readable, or 0 */
+    uint32_t readable;
+
+    /* This store block with message */
+    uint32_t block;
+
+} shared_box_t;
+
+/** \struct shared_region_t
+ * This struct store shared memory region, mapped into current process.
+ */
+typedef struct {
+
+    /* This store address of mapped region */
+    shared_header_t *header;
+
+    /* This store address of first message box */
+    shared_box_t *boxes;
+
+    /* This store next free block of each block */
+    uint32_t *next;
+
+    /* This store address of first block */
+    uint8_t *pool;
+
+    /* This store distance between blocks in bytes */
+    size_t stride;
+
+    /* This store size of mapped region in bytes */
+    size_t size;
+
+    /* This store last doorbell value, which had been seen */
+    uint32_t doorbell;
+
+    /* This store local pids bound to boxes, or NULL */
+    kernel_pid_t *bindings;
+
+} shared_region_t;
+
+/** \fn shared_create
+ * This create new shared memory region with given name.
+ * @param *region Region to work on
+ * @param *name Name of POSIX shared memory, like "/aiko"
+ * @param boxes Count of message boxes
+ * @param blocks Count of blocks in pool
+ * @param block_size Size of one block in bytes
+ * @return True if region had been created, false if not
+ */
+bool shared_create(
+    shared_region_t *region,
+    const char *name,
+    uint32_t boxes,
+    uint32_t blocks,
+    uint32_t block_size
+);
+
+/** \fn shared_open
+ * This map existing shared memory region with given name.
+ * @param *region Region to work on
+ * @param *name Name of POSIX shared memory
+ * @return True if region had been mapped, false if not
+ */
+bool shared_open(shared_region_t *region, const char *name);
+
+/** \fn shared_close
+ * This unmap region from current process.
+ * @param *region Region to work on
+ */
+void shared_close(shared_region_t *region);
+
+/** \fn shared_unlink
+ * This remove name of shared memory region. Region exists until all of 
+ * processes close it.
+ * @param *name Name of POSIX shared memory
+ */
+void shared_unlink(const char *name);
+
+/** \fn shared_alloc
+ * This take free block from pool.
+ * @param *region Region to work on
+ * @return Address of block, or NULL when pool is empty
+ */
+void* shared_alloc(shared_region_t *region);
+
+/** \fn shared_free
+ * This return block into pool.
+ * @param *region Region to work on
+ * @param *block Address of block
+ */
+void shared_free(shared_region_t *region, void *block);
+
+/** \fn shared_is_sendable
+ * This check if message can be send into box.
+ * @param *region Region to work on
+ * @param box Index of box
+ * @return True if box is sendable, false if not
+ */
+bool shared_is_sendable(shared_region_t *region, uint32_t box);
+
+/** \fn shared_send
+ * This send block from pool into box. Receiver owns block after that. 
+ * There is no syscall, when nobody sleeps on region.
+ * @param *region Region to work on
+ * @param box Index of box
+ * @param *block Block from pool
+ * @param length Length of message in bytes
+ * @return True if message had been send, false when box is full
+ */
+bool shared_send(
+    shared_region_t *region, 
+    uint32_t box, 
+    void *block, 
+    uint32_t length
+);
+
+/** \fn shared_receive
+ * This receive message from box. Receiver owns block after that, and must
+ * return it to pool by shared_free. When index of block in box is out of 
+ * pool, box is corrupt, it is emptied and message is dropped.
+ * @param *region Region to work on
+ * @param box Index of box
+ * @return Block with message, or NULL when box is empty or corrupt
+ */
+void* shared_receive(shared_region_t *region, uint32_t box);
+
+/** \fn shared_length
+ * This return length of message in block, set when it had been send.
+ * @param *block Block from pool
+ * @return Length of message in bytes
+ */
+uint32_t shared_length(void *block);
+
+/** \fn shared_bind
+ * This bind box to local process. shared_poll sends messages from box to 
+ * that process, as pointer to block.
+ * @param *region Region to work on
+ * @param box Index of box
+ * @param pid Pid of local process
+ * @return True if box had been bound, false if not
+ */
+bool shared_bind(shared_region_t *region, uint32_t box, kernel_pid_t pid);
+
+/** \fn shared_poll
+ * This move messages from bound boxes into message boxes of local processes.
+ * When nothing had been send since last poll, it only reads one counter.
+ * @param *region Region to work on
+ * @param *kernel Kernel with local processes
+ * @return Count of moved messages
+ */
+uint_t shared_poll(shared_region_t *region, kernel_instance_t *kernel);
+
+/** \fn shared_wait
+ * This sleep on futex, until anything is send into region, or until timeout.
+ * @param *region Region to work on
+ * @param timeout Timeout in milliseconds, or negative to wait forever
+ * @return True when anything had been send, false on timeout
+ */
+bool shared_wait(shared_region_t *region, int32_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_SIGNAL_SET_H_INCLUDED
+#define CX_AIKO_SIGNAL_SET_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "numbers.h"
+#include "process.h"
+#include "kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \def SIGNAL_SET_SIZE
+ * This is count of signals, which can be in set. Signal is number of bit.
+ */
+#define SIGNAL_SET_SIZE (sizeof(uintptr_t) * 8)
+
+/** \def SIGNAL_SET_NONE
+ * This is returned, when there is no more signals in set.
+ */
+#define SIGNAL_SET_NONE MAX_UINT_VALUE
+
+/** \fn signal_set_raise
+ * This add signal into pending set of each SIGNAL process, and make them 
+ * ready. Signals are never overwritten, and it can be called from 
+ * interrupts. Higher signal number has higher priority.
+ * @param *kernel Kernel instance to work on
+ * @param signal Number of signal, lower than SIGNAL_SET_SIZE
+ */
+void signal_set_raise(kernel_instance_t *kernel, uint_t signal);
+
+/** \fn signal_set_raise_process
+ * This add signal into pending set of one process, and make it ready. It 
+ * does nothing, when process is not SIGNAL process.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process
+ * @param signal Number of signal, lower than SIGNAL_SET_SIZE
+ */
+void signal_set_raise_process(
+    kernel_instance_t *kernel,
+    kernel_pid_t process_pid,
+    uint_t signal
+);
+
+/** \fn signal_set_take
+ * This take all of pending signals of process at once. Signals raised later
+ * make process ready again, so none of them is lost.
+ * @param *process Process to work on
+ * @return Set of signals, bit for each signal
+ */
+uintptr_t signal_set_take(process_t *process);
+
+/** \fn signal_set_pop
+ * This remove signal with highest priority from set.
+ * @param *set Set of signals
+ * @return Number of signal, or SIGNAL_SET_NONE when set is empty
+ */
+uint_t signal_set_pop(uintptr_t *set);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
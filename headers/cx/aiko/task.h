@@ -0,0 +1,114 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_TASK_H_INCLUDED
+#define CX_AIKO_TASK_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "numbers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \def TASK_LAST
+ * This is priority of task, which runs after all of processes.
+ */
+#define TASK_LAST MAX_UINT_VALUE
+
+/** \typedef task_function_t
+ * This is type of function posted as task. First parameter is kernel 
+ * instance, second is argument given when posting.
+ */
+typedef void (*task_function_t)(void *, void *);
+
+/** \struct task_t
+ * This struct store one task, it is in free list or in pending list.
+ */
+typedef struct task_s {
+
+    /* This store function to call */
+    task_function_t function;
+
+    /* This store argument of function */
+    void *argument;
+
+    /* This store pid of process, before which task runs */
+    uint_t priority;
+
+    /* This store next task in list */
+    struct task_s *next;
+
+} task_t;
+
+/** \struct task_pool_t
+ * This struct store pool of tasks with fixed size. Pending tasks are sorted
+ * by priority, tasks with the same priority run in order of posting.
+ */
+typedef struct {
+
+    /* This store first free task */
+    task_t *free;
+
+    /* This store first pending task */
+    task_t *pending;
+
+    /* This store last pending task */
+    task_t *last;
+
+} task_pool_t;
+
+/** \fn task_pool_create
+ * This create pool of tasks in given memory.
+ * @param *pool Pool to work on
+ * @param *tasks Memory for tasks
+ * @param size Count of tasks
+ */
+void task_pool_create(task_pool_t *pool, task_t *tasks, uint_t size);
+
+/** \fn task_pool_post
+ * This take task from free list and put it into pending list.
+ * @param *pool Pool to work on
+ * @param function Function to call
+ * @param *argument Argument of function
+ * @param priority Pid of process, before which task runs, or TASK_LAST
+ * @return True if task had been posted, false when pool is empty
+ */
+bool task_pool_post(
+    task_pool_t *pool,
+    task_function_t function,
+    void *argument,
+    uint_t priority
+);
+
+/** \fn task_pool_detach
+ * This take all of pending tasks, tasks posted later wait for next detach.
+ * @param *pool Pool to work on
+ * @return First of pending tasks, or NULL
+ */
+task_t* task_pool_detach(task_pool_t *pool);
+
+/** \fn task_pool_release
+ * This return task into free list.
+ * @param *pool Pool to work on
+ * @param *task Task to return
+ */
+static inline void task_pool_release(task_pool_t *pool, task_t *task) {
+    task->next = pool->free;
+    pool->free = task;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
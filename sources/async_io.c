@@ -0,0 +1,322 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include "numbers.h"
+#include "deferred.h"
+#include "kernel.h"
+#include "async_io.h"
+
+/* This is first wait in nanoseconds, when deferred queue is full */
+#define ASYNC_IO_MIN_BACKOFF 1000L
+
+/* This is longest wait in nanoseconds, when deferred queue is full */
+#define ASYNC_IO_MAX_BACKOFF 1000000L
+
+/** \fn async_io_take
+ * This wait for request and take it out of queue.
+ * @param *io Pool to work on
+ * @return Request, or NULL when pool is stopping
+ */
+static async_io_request_t* async_io_take(async_io_t *io) {
+    pthread_mutex_lock(&io->lock);
+
+    while (io->running && io->first == NULL) {
+        pthread_cond_wait(&io->submitted, &io->lock);
+    }
+
+    async_io_request_t *request = NULL;
+
+    if (io->running) {
+        request = io->first;
+        io->first = request->next;
+
+        if (io->first == NULL) io->last = NULL;
+    }
+
+    pthread_mutex_unlock(&io->lock);
+    return request;
+}
+
+/** \fn async_io_do
+ * This do operation of request.
+ * @param *io Pool to work on
+ * @param *request Request to do
+ */
+static void async_io_do(async_io_t *io, async_io_request_t *request) {
+    void *data = async_io_data(io, request);
+    off_t position = (off_t)(request->position);
+    ssize_t result = -1;
+
+    do {
+        switch (request->operation) {
+            case ASYNC_IO_READ:
+                result = pread(
+                    request->descriptor, 
+                    data, 
+                    request->length, 
+                    position
+                );
+                break;
+
+            case ASYNC_IO_WRITE:
+                result = pwrite(
+                    request->descriptor, 
+                    data, 
+                    request->length, 
+                    position
+                );
+                break;
+
+            case ASYNC_IO_FSYNC:
+                result = fsync(request->descriptor);
+                break;
+        }
+    } while (result < 0 && errno == EINTR);
+
+    request->result = (long)(result);
+    request->error = (result < 0) ? errno : 0x00;
+}
+
+/** \fn async_io_is_running
+ * This check if pool is not stopping.
+ * @param *io Pool to work on
+ * @return True if pool is running, false if it is stopping
+ */
+static bool async_io_is_running(async_io_t *io) {
+    pthread_mutex_lock(&io->lock);
+    bool running = io->running;
+    pthread_mutex_unlock(&io->lock);
+
+    return running;
+}
+
+/** \fn async_io_complete
+ * This post completion of request to deferred queue of kernel. When queue
+ * is full, thread sleeps, each time twice longer, until scheduler makes 
+ * place in queue, or until pool is stopping.
+ * @param *io Pool to work on
+ * @param *request Done request
+ */
+static void async_io_complete(async_io_t *io, async_io_request_t *request) {
+    long backoff = ASYNC_IO_MIN_BACKOFF;
+
+    while (!deferred_post_message(
+        io->kernel->deferred, 
+        request->pid, 
+        request
+    )) {
+        if (!async_io_is_running(io)) return;
+
+        struct timespec wait = { 0, backoff };
+
+        nanosleep(&wait, NULL);
+
+        if (backoff < ASYNC_IO_MAX_BACKOFF) backoff *= 2;
+    }
+}
+
+/** \fn async_io_thread
+ * This is main function of pool threads.
+ * @param *argument Pool to work on
+ * @return Nothing
+ */
+static void* async_io_thread(void *argument) {
+    async_io_t *io = argument;
+    async_io_request_t *request;
+
+    while ((request = async_io_take(io)) != NULL) {
+        async_io_do(io, request);
+        async_io_complete(io, request);
+    }
+
+    return NULL;
+}
+
+/** \fn async_io_create
+ * This start pool of threads. Kernel must have deferred queue, which gets
+ * completions.
+ * @param *io Pool to work on
+ * @param *kernel Kernel, which gets completions
+ * @param threads Count of threads
+ * @return True if pool had been started, false if not
+ */
+bool async_io_create(
+    async_io_t *io, 
+    kernel_instance_t *kernel, 
+    uint_t threads
+) {
+    if (kernel->deferred == NULL) return false;
+    if (threads == 0x00) threads = 0x01;
+    if (threads > ASYNC_IO_MAX_THREADS) threads = ASYNC_IO_MAX_THREADS;
+
+    io->kernel = kernel;
+    io->buffers = NULL;
+    io->buffers_count = 0x00;
+    io->threads_count = 0x00;
+    io->first = NULL;
+    io->last = NULL;
+    io->running = true;
+
+    pthread_mutex_init(&io->lock, NULL);
+    pthread_cond_init(&io->submitted, NULL);
+
+    for (uint_t count = 0x00; count < threads; ++count) {
+        pthread_t *thread = io->threads + count;
+
+        if (pthread_create(thread, NULL, async_io_thread, io) != 0) break;
+
+        ++io->threads_count;
+    }
+
+    if (io->threads_count != 0x00) return true;
+
+    async_io_remove(io);
+    return false;
+}
+
+/** \fn async_io_remove
+ * This stop pool of threads. Requests, which had not been started yet, are
+ * not done.
+ * @param *io Pool to work on
+ */
+void async_io_remove(async_io_t *io) {
+    pthread_mutex_lock(&io->lock);
+    io->running = false;
+    pthread_cond_broadcast(&io->submitted);
+    pthread_mutex_unlock(&io->lock);
+
+    for (uint_t count = 0x00; count < io->threads_count; ++count) {
+        pthread_join(io->threads[count], NULL);
+    }
+
+    io->threads_count = 0x00;
+
+    pthread_cond_destroy(&io->submitted);
+    pthread_mutex_destroy(&io->lock);
+}
+
+/** \fn async_io_register
+ * This register buffers, which requests can use. Data are read and write
+ * directly from and into them, without copying.
+ * @param *io Pool to work on
+ * @param *buffers Static array of buffers
+ * @param count Count of buffers
+ */
+void async_io_register(
+    async_io_t *io, 
+    async_io_buffer_t *buffers, 
+    uint_t count
+) {
+    pthread_mutex_lock(&io->lock);
+    io->buffers = buffers;
+    io->buffers_count = count;
+    pthread_mutex_unlock(&io->lock);
+}
+
+/** \fn async_io_prepare
+ * This fill request with given params.
+ * @param *request Request to work on
+ * @param operation Operation to do
+ * @param descriptor File descriptor
+ * @param buffer Index of registered buffer
+ * @param offset Offset of data in buffer
+ * @param length Count of bytes
+ * @param position Position in file
+ * @param pid Pid of process, which gets completion
+ */
+void async_io_prepare(
+    async_io_request_t *request,
+    async_io_operation_t operation,
+    int descriptor,
+    uint_t buffer,
+    size_t offset,
+    size_t length,
+    int64_t position,
+    kernel_pid_t pid
+) {
+    request->operation = operation;
+    request->descriptor = descriptor;
+    request->buffer = buffer;
+    request->offset = offset;
+    request->length = length;
+    request->position = position;
+    request->pid = pid;
+    request->result = 0x00;
+    request->error = 0x00;
+    request->next = NULL;
+}
+
+/** \fn async_io_submit
+ * This submit request to pool. It does not block on storage.
+ * @param *io Pool to work on
+ * @param *request Request to submit
+ * @return True if request had been submitted, false if it is invalid
+ */
+bool async_io_submit(async_io_t *io, async_io_request_t *request) {
+    pthread_mutex_lock(&io->lock);
+
+    if (request->operation != ASYNC_IO_FSYNC) {
+        bool valid = request->buffer < io->buffers_count;
+
+        if (valid) {
+            size_t size = (io->buffers + request->buffer)->size;
+
+            valid = request->offset <= size;
+            valid = valid && request->length <= size - request->offset;
+        }
+
+        if (!valid) {
+            pthread_mutex_unlock(&io->lock);
+            return false;
+        }
+    }
+
+    request->next = NULL;
+
+    if (io->last == NULL) io->first = request;
+    else io->last->next = request;
+
+    io->last = request;
+
+    pthread_cond_signal(&io->submitted);
+    pthread_mutex_unlock(&io->lock);
+
+    return true;
+}
+
+/** \fn async_io_data
+ * This return address of data of request in registered buffer.
+ * @param *io Pool to work on
+ * @param *request Request to work on
+ * @return Address of data
+ */
+void* async_io_data(async_io_t *io, async_io_request_t *request) {
+    uint8_t *address = NULL;
+
+    pthread_mutex_lock(&io->lock);
+
+    if (request->buffer < io->buffers_count) {
+        address = (io->buffers + request->buffer)->address;
+        address += request->offset;
+    }
+
+    pthread_mutex_unlock(&io->lock);
+    return address;
+}
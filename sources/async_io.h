@@ -0,0 +1,213 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_ASYNC_IO_H_INCLUDED
+#define CX_AIKO_ASYNC_IO_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "numbers.h"
+#include "kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \def ASYNC_IO_MAX_THREADS
+ * This define max count of threads, which do input and output.
+ */
+#define ASYNC_IO_MAX_THREADS 8
+
+/** \enum async_io_operation_t
+ * This store operation, which request do.
+ */
+typedef enum {
+
+    /* Read from file into buffer */
+    ASYNC_IO_READ = 0x00,
+
+    /* Write from buffer into file */
+    ASYNC_IO_WRITE = 0x01,
+
+    /* Flush file to storage */
+    ASYNC_IO_FSYNC = 0x02
+
+} async_io_operation_t;
+
+/** \struct async_io_buffer_t
+ * This struct store buffer registered for input and output.
+ */
+typedef struct {
+
+    /* This store address of buffer */
+    void *address;
+
+    /* This store size of buffer in bytes */
+    size_t size;
+
+} async_io_buffer_t;
+
+/** \struct async_io_request_t
+ * This struct store one request. When it is done, pointer to it is send as
+ * message to process with pid from request. Request memory is owned by 
+ * project, and must live until completion is received.
+ */
+typedef struct {
+
+    /* This store operation to do */
+    async_io_operation_t operation;
+
+    /* This store file descriptor to work on */
+    int descriptor;
+
+    /* This store index of registered buffer */
+    uint_t buffer;
+
+    /* This store offset of data in buffer */
+    size_t offset;
+
+    /* This store count of bytes to read or write */
+    size_t length;
+
+    /* This store position in file */
+    int64_t position;
+
+    /* This store pid of process, which gets completion */
+    kernel_pid_t pid;
+
+    /* This store count of bytes done, or -1 on error */
+    long result;
+
+    /* This store errno of failed operation, or 0 */
+    int error;
+
+    /* This store next request in queue */
+    void *next;
+
+} async_io_request_t;
+
+/** \struct async_io_t
+ * This struct store pool of threads, which do input and output for kernel.
+ * Completions are posted to deferred queue of kernel, so scheduler thread
+ * never blocks on storage.
+ */
+typedef struct {
+
+    /* This store kernel, which gets completions */
+    kernel_instance_t *kernel;
+
+    /* This store address of first registered buffer */
+    async_io_buffer_t *buffers;
+
+    /* This store count of registered buffers */
+    uint_t buffers_count;
+
+    /* This store threads of pool */
+    pthread_t threads[ASYNC_IO_MAX_THREADS];
+
+    /* This store count of started threads */
+    uint_t threads_count;
+
+    /* This protect queue of requests */
+    pthread_mutex_t lock;
+
+    /* This wake threads, when request is submitted */
+    pthread_cond_t submitted;
+
+    /* This store first request in queue */
+    async_io_request_t *first;
+
+    /* This store last request in queue */
+    async_io_request_t *last;
+
+    /* False when pool is stopping */
+    bool running;
+
+} async_io_t;
+
+/** \fn async_io_create
+ * This start pool of threads. Kernel must have deferred queue, which gets
+ * completions.
+ * @param *io Pool to work on
+ * @param *kernel Kernel, which gets completions
+ * @param threads Count of threads
+ * @return True if pool had been started, false if not
+ */
+bool async_io_create(
+    async_io_t *io, 
+    kernel_instance_t *kernel, 
+    uint_t threads
+);
+
+/** \fn async_io_remove
+ * This stop pool of threads. Requests, which had not been started yet, are
+ * not done.
+ * @param *io Pool to work on
+ */
+void async_io_remove(async_io_t *io);
+
+/** \fn async_io_register
+ * This register buffers, which requests can use. Data are read and write
+ * directly from and into them, without copying.
+ * @param *io Pool to work on
+ * @param *buffers Static array of buffers
+ * @param count Count of buffers
+ */
+void async_io_register(
+    async_io_t *io, 
+    async_io_buffer_t *buffers, 
+    uint_t count
+);
+
+/** \fn async_io_prepare
+ * This fill request with given params.
+ * @param *request Request to work on
+ * @param operation Operation to do
+ * @param descriptor File descriptor
+ * @param buffer Index of registered buffer
+ * @param offset Offset of data in buffer
+ * @param length Count of bytes
+ * @param position Position in file
+ * @param pid Pid of process, which gets completion
+ */
+void async_io_prepare(
+    async_io_request_t *request,
+    async_io_operation_t operation,
+    int descriptor,
+    uint_t buffer,
+    size_t offset,
+    size_t length,
+    int64_t position,
+    kernel_pid_t pid
+);
+
+/** \fn async_io_submit
+ * This submit request to pool. It does not block on storage.
+ * @param *io Pool to work on
+ * @param *request Request to submit
+ * @return True if request had been submitted, false if it is invalid
+ */
+bool async_io_submit(async_io_t *io, async_io_request_t *request);
+
+/** \fn async_io_data
+ * This return address of data of request in registered buffer.
+ * @param *io Pool to work on
+ * @param *request Request to work on
+ * @return Address of data
+ */
+void* async_io_data(async_io_t *io, async_io_request_t *request);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
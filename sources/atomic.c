@@ -0,0 +1,53 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+#include "atomic.h"
+
+/* This check at compile time, that signal mask fits into state */
+typedef char critical_state_fits[
+    sizeof(sigset_t) <= sizeof(critical_state_t) ? 1 : -1
+];
+
+/** \fn critical_enter
+ * This function starts critical section. On Linux it blocks signals in
+ * current thread. Critical sections can be nested, each of them restores 
+ * its own state.
+ * @return State to restore by critical_leave
+ */
+critical_state_t critical_enter(void) {
+    critical_state_t state;
+    sigset_t all;
+    sigset_t saved;
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &saved);
+    memcpy(state.mask, &saved, sizeof(sigset_t));
+
+    return state;
+}
+
+/** \fn critical_leave
+ * This function ends critical section, started by critical_enter.
+ * @param state State returned by critical_enter
+ */
+void critical_leave(critical_state_t state) {
+    sigset_t saved;
+
+    memcpy(&saved, state.mask, sizeof(sigset_t));
+    pthread_sigmask(SIG_SETMASK, &saved, NULL);
+}
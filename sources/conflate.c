@@ -0,0 +1,174 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "numbers.h"
+#include "kernel.h"
+#include "atomic.h"
+#include "conflate.h"
+
+/** \fn conflate_deliver
+ * This send mailbox to consumer, when any of values is pending and 
+ * consumer does not have message yet. Scheduler calls it from poll, so 
+ * interrupt does not touch process table, and notify is never lost.
+ * @param *kernel Kernel instance, not used
+ * @param *argument Mailbox to work on
+ */
+static void conflate_deliver(void *kernel, void *argument) {
+    conflate_t *conflate = (conflate_t *)(argument);
+    kernel_pid_t pid = conflate->pid;
+
+    (void)(kernel);
+
+    if (!conflate_is_pending(conflate)) return;
+    if (!kernel_is_process_message_box_sendable(conflate->kernel, pid)) {
+        return;
+    }
+
+    kernel_process_message_box_send(conflate->kernel, pid, conflate);
+}
+
+/** \fn conflate_create
+ * This create conflating mailbox in given memory. Consumer gets pointer to
+ * mailbox as message, when first of values is pending. Message is send by 
+ * scheduler, from poll which mailbox adds to kernel.
+ * @param *conflate Mailbox to work on
+ * @param *slots Slots, one for each key
+ * @param size Count of keys
+ * @param *kernel Kernel with consumer process
+ * @param pid Pid of consumer process
+ */
+void conflate_create(
+    conflate_t *conflate,
+    conflate_slot_t *slots,
+    uint_t size,
+    kernel_instance_t *kernel,
+    kernel_pid_t pid
+) {
+    for (uint_t key = 0x00; key < size; ++key) {
+        (slots + key)->value = NULL;
+        (slots + key)->coalesced = 0x00;
+        (slots + key)->next = CONFLATE_NONE;
+        (slots + key)->pending = 0x00;
+    }
+
+    conflate->slots = slots;
+    conflate->size = size;
+    conflate->head = CONFLATE_NONE;
+    conflate->pushed = CONFLATE_NONE;
+    conflate->coalesced = 0x00;
+    conflate->kernel = kernel;
+    conflate->pid = pid;
+
+    kernel_add_poll(kernel, &conflate->poll, conflate_deliver, conflate);
+}
+
+/** \fn conflate_send
+ * This send value with key. When previous value of key had not been taken,
+ * it is replaced and counted as coalesced. Value send while consumer takes 
+ * that key can be taken twice, but it is always latest value.
+ * @param *conflate Mailbox to work on
+ * @param key Key of value
+ * @param *value Value to send
+ * @return True if value had been send, false when key is out of mailbox
+ */
+bool conflate_send(conflate_t *conflate, uint_t key, void *value) {
+    if (key >= conflate->size) return false;
+
+    conflate_slot_t *slot = conflate->slots + key;
+    uint_t idle = 0x00;
+
+    atomic_pointer_store(&slot->value, value);
+
+    if (!atomic_uint_compare_exchange(&slot->pending, &idle, 0x01)) {
+        atomic_uint_fetch_add(&slot->coalesced, 0x01);
+        atomic_uint_fetch_add(&conflate->coalesced, 0x01);
+
+        return true;
+    }
+
+    uint_t top = atomic_uint_load(&conflate->pushed);
+
+    do {
+        slot->next = top;
+    } while (!atomic_uint_compare_exchange(&conflate->pushed, &top, key));
+
+    if (top == CONFLATE_NONE) {
+        kernel_request_poll(conflate->kernel, &conflate->poll);
+    }
+
+    return true;
+}
+
+/** \fn conflate_take_over
+ * This take over keys pushed by producers. Producers push keys on stack, 
+ * so order of keys is reversed here.
+ * @param *conflate Mailbox to work on
+ */
+static void conflate_take_over(conflate_t *conflate) {
+    uint_t key = atomic_uint_exchange(&conflate->pushed, CONFLATE_NONE);
+    uint_t head = CONFLATE_NONE;
+
+    while (key != CONFLATE_NONE) {
+        conflate_slot_t *slot = conflate->slots + key;
+        uint_t next = slot->next;
+
+        slot->next = head;
+        head = key;
+        key = next;
+    }
+
+    conflate->head = head;
+}
+
+/** \fn conflate_take
+ * This take latest value of next pending key, in order in which keys 
+ * became pending. Only consumer process can call it.
+ * @param *conflate Mailbox to work on
+ * @param *key Place to store key
+ * @param **value Place to store value
+ * @param *coalesced Place to store count of replaced values, or NULL
+ * @return True if value had been taken, false when nothing is pending
+ */
+bool conflate_take(
+    conflate_t *conflate,
+    uint_t *key,
+    void **value,
+    uint_t *coalesced
+) {
+    if (conflate->head == CONFLATE_NONE) conflate_take_over(conflate);
+    if (conflate->head == CONFLATE_NONE) return false;
+
+    conflate_slot_t *slot = conflate->slots + conflate->head;
+    uint_t replaced = atomic_uint_exchange(&slot->coalesced, 0x00);
+
+    *key = conflate->head;
+    conflate->head = slot->next;
+
+    if (coalesced != NULL) *coalesced = replaced;
+
+    atomic_uint_store(&slot->pending, 0x00);
+    *value = atomic_pointer_load(&slot->value);
+
+    return true;
+}
+
+/** \fn conflate_is_pending
+ * This check if any of values waits for consumer.
+ * @param *conflate Mailbox to work on
+ * @return True if any of values is pending, false if not
+ */
+bool conflate_is_pending(conflate_t *conflate) {
+    if (conflate->head != CONFLATE_NONE) return true;
+
+    return atomic_uint_load(&conflate->pushed) != CONFLATE_NONE;
+}
@@ -0,0 +1,220 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "numbers.h"
+#include "atomic.h"
+#include "deferred.h"
+
+/** \fn deferred_create
+ * This prepare deferred queue to work.
+ * @param *queue Queue to work on
+ * @param *entries Static table of entries
+ * @param size Count of entries, rounded down to power of two
+ */
+void deferred_create(
+    deferred_t *queue, 
+    deferred_entry_t *entries, 
+    uint_t size
+) {
+    if (size > MAX_DEFERRED_SIZE) size = MAX_DEFERRED_SIZE;
+
+    uint_t count = 0x01;
+
+    while (count <= size / 2) count <<= 1;
+
+    queue->entries = entries;
+    queue->mask = count - 1;
+    queue->head = 0x00;
+    queue->tail = 0x00;
+    queue->waker = NULL;
+    queue->waking = 0x00;
+
+    for (uint_t entry = 0x00; entry < count; ++entry) {
+        (entries + entry)->sequence = entry;
+    }
+}
+
+/** \fn deferred_set_wake
+ * This set waker, which is called after each post, to wake consumer up
+ * when it sleeps. It can be changed while other threads post. It returns 
+ * when wake functions of previous waker had ended, so its sleeper can be
+ * freed. It must not be called from interrupt.
+ * @param *queue Queue to work on
+ * @param *waker Waker to call, or NULL
+ */
+void deferred_set_wake(deferred_t *queue, deferred_waker_t *waker) {
+    atomic_pointer_store(&queue->waker, waker);
+    atomic_fence();
+
+    while (atomic_uint_load(&queue->waking) != 0x00) {}
+}
+
+/** \fn deferred_wake
+ * This call wake function of queue, when it is set. It is called after 
+ * each post, and can be called when interrupt gives work to consumer by 
+ * other way.
+ * @param *queue Queue to work on
+ */
+void deferred_wake(deferred_t *queue) {
+    atomic_uint_fetch_add(&queue->waking, 0x01);
+    atomic_fence();
+
+    deferred_waker_t *waker = atomic_pointer_load(&queue->waker);
+
+    if (waker != NULL) waker->wake(waker->sleeper);
+
+    atomic_uint_fetch_sub(&queue->waking, 0x01);
+}
+
+/** \fn deferred_reserve
+ * This reserve entry for new work. 
+ * @param *queue Queue to work on
+ * @param *position Place to store reserved position
+ * @return Reserved entry, or NULL when queue is full
+ */
+static inline deferred_entry_t* deferred_reserve(
+    deferred_t *queue, 
+    uint_t *position
+) {
+    uint_t current = atomic_uint_load(&queue->tail);
+
+    while (true) {
+        deferred_entry_t *entry = queue->entries + (current & queue->mask);
+        uint_t sequence = atomic_uint_load(&entry->sequence);
+        int_t difference = (int_t)(uint_t)(sequence - current);
+
+        if (difference < 0) return NULL;
+
+        if (difference > 0) {
+            current = atomic_uint_load(&queue->tail);
+            continue;
+        }
+
+        uint_t next = current + 1;
+
+        if (!atomic_uint_compare_exchange(&queue->tail, &current, next)) {
+            continue;
+        }
+
+        *position = current;
+        return entry;
+    }
+}
+
+/** \fn deferred_post_message
+ * This post message, which scheduler would send to process with given pid.
+ * It is safe to call it from interrupts. Then it wakes consumer up.
+ * @param *queue Queue to work on
+ * @param pid Pid of process to send
+ * @param *message Message to send
+ * @return True if message had been posted, false if queue is full
+ */
+bool deferred_post_message(deferred_t *queue, uint_t pid, void *message) {
+    uint_t position;
+    deferred_entry_t *entry = deferred_reserve(queue, &position);
+
+    if (entry == NULL) return false;
+
+    entry->pid = pid;
+    entry->function = NULL;
+    entry->argument = message;
+
+    atomic_uint_store(&entry->sequence, position + 1);
+    deferred_wake(queue);
+    return true;
+}
+
+/** \fn deferred_post_function
+ * This post function, which scheduler would call with given argument. It is
+ * safe to call it from interrupts. Then it wakes consumer up.
+ * @param *queue Queue to work on
+ * @param function Function to call
+ * @param *argument Argument of function
+ * @return True if function had been posted, false if queue is full
+ */
+bool deferred_post_function(
+    deferred_t *queue, 
+    deferred_function_t function, 
+    void *argument
+) {
+    uint_t position;
+    deferred_entry_t *entry = deferred_reserve(queue, &position);
+
+    if (entry == NULL) return false;
+
+    entry->function = function;
+    entry->argument = argument;
+
+    atomic_uint_store(&entry->sequence, position + 1);
+    deferred_wake(queue);
+    return true;
+}
+
+/** \fn deferred_peek
+ * This return first posted entry, without taking it out. Only one consumer
+ * can take entries out of queue.
+ * @param *queue Queue to work on
+ * @return First entry, or NULL when queue is empty
+ */
+deferred_entry_t* deferred_peek(deferred_t *queue) {
+    deferred_entry_t *entry = queue->entries + (queue->head & queue->mask);
+    uint_t sequence = atomic_uint_load(&entry->sequence);
+    uint_t ready = queue->head + 1;
+
+    if ((int_t)(uint_t)(sequence - ready) < 0) return NULL;
+
+    return entry;
+}
+
+/** \fn deferred_pop
+ * This take out first entry, returned by deferred_peek.
+ * @param *queue Queue to work on
+ */
+void deferred_pop(deferred_t *queue) {
+    deferred_entry_t *entry = queue->entries + (queue->head & queue->mask);
+
+    atomic_uint_store(&entry->sequence, queue->head + queue->mask + 1);
+    ++queue->head;
+}
+
+/** \fn deferred_requeue
+ * This move first entry, returned by deferred_peek, to end of queue. Only 
+ * consumer can call it.
+ * @param *queue Queue to work on
+ * @return True if entry had been moved, false if queue is full
+ */
+bool deferred_requeue(deferred_t *queue) {
+    deferred_entry_t *entry = queue->entries + (queue->head & queue->mask);
+    uint_t position;
+    deferred_entry_t *moved = deferred_reserve(queue, &position);
+
+    if (moved == NULL) return false;
+
+    moved->pid = entry->pid;
+    moved->function = entry->function;
+    moved->argument = entry->argument;
+
+    atomic_uint_store(&moved->sequence, position + 1);
+    deferred_pop(queue);
+    return true;
+}
+
+/** \fn deferred_count
+ * This return count of entries posted to queue and not taken out yet, it 
+ * counts entries which are still being posted too.
+ * @param *queue Queue to work on
+ * @return Count of entries
+ */
+uint_t deferred_count(deferred_t *queue) {
+    return (uint_t)(atomic_uint_load(&queue->tail) - queue->head);
+}
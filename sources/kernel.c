@@ -15,8 +15,62 @@
 #include "process.h"
 #include "message_box.h"
 #include "numbers.h"
+#include "deferred.h"
+#include "atomic.h"
+#include "task.h"
+#include "latency.h"
 #include "kernel.h"
 
+/** \fn kernel_process
+ * This return process with given pid, without checking table bounds.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process to return
+ * @return Process with given pid
+ */
+static inline process_t* kernel_process(
+    kernel_instance_t *kernel,
+    kernel_pid_t process_pid
+) {
+#ifdef AIKO_SEGMENTED_KERNEL
+    if (kernel->segments == NULL) return kernel->processes + process_pid;
+
+    uint_t mask = (uint_t)((1U << kernel->segment_shift) - 1);
+
+    return kernel->segments[process_pid >> kernel->segment_shift] + 
+        (process_pid & mask);
+#else
+    return kernel->processes + process_pid;
+#endif
+}
+
+/** \fn kernel_process_type
+ * This return type of process with given pid, without checking table bounds.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process to check
+ * @return Type of process
+ */
+static inline process_type_t kernel_process_type(
+    kernel_instance_t *kernel,
+    kernel_pid_t process_pid
+) {
+    return PROCESS_GET_TYPE(kernel_process(kernel, process_pid));
+}
+
+#ifdef AIKO_SEGMENTED_KERNEL
+
+/** \fn kernel_segments_count
+ * This return count of segments in segmented kernel.
+ * @param *kernel Kernel instance to work on
+ * @return Count of segments
+ */
+static inline kernel_pid_t kernel_segments_count(kernel_instance_t *kernel) {
+    if (kernel->size == 0x00) return 0x00;
+
+    return ((kernel->size - 1) >> kernel->segment_shift) + 1;
+}
+
+#endif
+
 /** \fn kernel_create 
  * This create instance of kernel.
  * @param *kernel Kernel instance to work on
@@ -28,6 +82,23 @@ void kernel_create(kernel_instance_t *kernel, uint_t size) {
     kernel->processes = malloc(sizeof(process_t) * size);
     kernel->size = size;
     kernel->last_changed = ERROR_PID;
+    kernel->cursor = 0x00;
+#ifdef AIKO_SEGMENTED_KERNEL
+    kernel->segments = NULL;
+    kernel->used = 0x00;
+    kernel->segment_shift = 0x00;
+#endif
+    kernel->deferred = NULL;
+    kernel->polls = NULL;
+    kernel->tasks = NULL;
+    kernel->clock = NULL;
+#ifdef AIKO_LATENCY
+    kernel->latency = NULL;
+    kernel->latency_size = 0x00;
+#endif
+#ifdef AIKO_STATISTICS
+    kernel_reset_statistics(kernel);
+#endif
 
     for (kernel_pid_t count = 0x00; count < size; ++count) {
         process_create(kernel->processes + count);
@@ -50,19 +121,185 @@ void kernel_create_static(
     kernel->processes = processes;
     kernel->size = size;
     kernel->last_changed = ERROR_PID;
+    kernel->cursor = 0x00;
+#ifdef AIKO_SEGMENTED_KERNEL
+    kernel->segments = NULL;
+    kernel->used = 0x00;
+    kernel->segment_shift = 0x00;
+#endif
+    kernel->deferred = NULL;
+    kernel->polls = NULL;
+    kernel->tasks = NULL;
+    kernel->clock = NULL;
+#ifdef AIKO_LATENCY
+    kernel->latency = NULL;
+    kernel->latency_size = 0x00;
+#endif
+#ifdef AIKO_STATISTICS
+    kernel_reset_statistics(kernel);
+#endif
 
     for (kernel_pid_t count = 0x00; count < size; ++count) {
         process_create(kernel->processes + count);
     } 
 }
 
+#ifdef AIKO_SEGMENTED_KERNEL
+
+/** \fn kernel_create_segmented
+ * This create kernel, which process table grows in segments on demand. 
+ * Segments are never moved, so process_t pointers stay valid until process
+ * segment is released by kernel_shrink.
+ * @param *kernel Kernel instance to work on
+ * @param segment_size Count of processes in one segment, rounded up to power
+ *                     of two
+ */
+void kernel_create_segmented(kernel_instance_t *kernel, uint_t segment_size) {
+    if (segment_size > MAX_SEGMENT_SIZE) segment_size = MAX_SEGMENT_SIZE;
+
+    kernel->segment_shift = 0x00;
+    
+    while ((1U << kernel->segment_shift) < segment_size) {
+        ++kernel->segment_shift;
+    }
+
+    kernel->processes = NULL;
+    kernel->segments = NULL;
+    kernel->size = 0x00;
+    kernel->last_changed = ERROR_PID;
+    kernel->cursor = 0x00;
+    kernel->used = 0x00;
+    kernel->deferred = NULL;
+    kernel->polls = NULL;
+    kernel->tasks = NULL;
+    kernel->clock = NULL;
+#ifdef AIKO_LATENCY
+    kernel->latency = NULL;
+    kernel->latency_size = 0x00;
+#endif
+#ifdef AIKO_STATISTICS
+    kernel_reset_statistics(kernel);
+#endif
+
+    process_t **segments = malloc(sizeof(process_t *));
+
+    if (segments == NULL) return;
+
+    segments[0] = NULL;
+    kernel->segments = segments;
+
+    if (!kernel_grow(kernel)) return;
+
+    kernel->processes = kernel->segments[0];
+}
+
+/** \fn kernel_grow
+ * This function add new segment to segmented kernel.
+ * @param *kernel Kernel instance to work on
+ * @return True if kernel had been grown, false if not
+ */
+bool kernel_grow(kernel_instance_t *kernel) {
+    if (kernel->segments == NULL) return false;
+    if (kernel->size >= MAX_PID_VALUE) return false;
+
+    kernel_pid_t count = kernel_segments_count(kernel);
+    unsigned long segment_size = 1UL << kernel->segment_shift;
+
+    process_t **segments = kernel->segments;
+
+    if (count > 0x00) {
+        segments = realloc(segments, sizeof(process_t *) * (count + 1));
+        
+        if (segments == NULL) return false;
+
+        kernel->segments = segments;
+    }
+
+    process_t *segment = malloc(sizeof(process_t) * segment_size);
+
+    if (segment == NULL) return false;
+
+    for (unsigned long process = 0x00; process < segment_size; ++process) {
+        process_create(segment + process);
+    }
+
+    unsigned long size = (unsigned long)(kernel->size) + segment_size;
+
+    if (size > MAX_PID_VALUE) size = MAX_PID_VALUE;
+
+    segments[count] = segment;
+    kernel->size = (kernel_pid_t)(size);
+
+    return true;
+}
+
+/** \fn kernel_shrink
+ * This function release empty segments from end of segmented kernel. First
+ * segment is never released. When kernel has not any segment, because 
+ * first of them could not be allocated, directory of segments is released,
+ * and kernel can only be removed. Call it only outside of scheduler, when 
+ * no one use process_t pointers to released processes.
+ * @param *kernel Kernel instance to work on
+ */
+void kernel_shrink(kernel_instance_t *kernel) {
+    if (kernel->segments == NULL) return;
+
+    kernel_pid_t count = kernel_segments_count(kernel);
+
+    while (count > 0x01) {
+        kernel_pid_t first = (count - 1) << kernel->segment_shift;
+        kernel_pid_t last_changed = kernel->last_changed;
+
+        if (kernel->used > first) break;
+        if (last_changed != ERROR_PID && last_changed >= first) break;
+
+        free(kernel->segments[count - 1]);
+
+        kernel->size = first;
+        --count;
+    }
+
+    if (count == 0x00) {
+        free(kernel->segments);
+        kernel->segments = NULL;
+        kernel->processes = NULL;
+        return;
+    }
+
+    process_t **segments = realloc(
+        kernel->segments, 
+        sizeof(process_t *) * count
+    );
+
+    if (segments != NULL) kernel->segments = segments;
+}
+
+#endif
+
 /** \fn kernel_remove
  * This function remove kernel instance and dealocate memory.
  * @param *kernel Kernel instance to work on
  */
 void kernel_remove(kernel_instance_t *kernel) {
+#ifdef AIKO_SEGMENTED_KERNEL
+    if (kernel->segments == NULL) {
+        kernel->size = 0x00;
+        free(kernel->processes);
+        return;
+    }
+
+    kernel_pid_t count = kernel_segments_count(kernel);
+
+    for (kernel_pid_t segment = 0x00; segment < count; ++segment) {
+        free(kernel->segments[segment]);
+    }
+
+    kernel->size = 0x00;
+    free(kernel->segments);
+#else
     kernel->size = 0x00;
     free(kernel->processes);
+#endif
 }
 
 /** \fn kernel_remove_static
@@ -73,39 +310,313 @@ void kernel_remove_static(kernel_instance_t *kernel) {
     kernel->size = 0x00;
 }
 
+#ifdef AIKO_LATENCY
+
+/** \fn kernel_latency_stamp
+ * This store time of send in message box of process.
+ * @param *kernel Kernel instance to work on
+ * @param *process Process, which gets message
+ */
+static inline void kernel_latency_stamp(
+    kernel_instance_t *kernel, 
+    process_t *process
+) {
+    if (kernel->latency == NULL || kernel->clock == NULL) return;
+
+    kernel_time_t now = kernel->clock();
+
+    if (now == MESSAGE_BOX_NO_STAMP) ++now;
+
+    process->message->stamp = now;
+}
+
+/** \fn kernel_latency_record
+ * This record latency of stamped message, before process is executed.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process
+ * @param *process Process with given pid
+ */
+static inline void kernel_latency_record(
+    kernel_instance_t *kernel, 
+    kernel_pid_t process_pid,
+    process_t *process
+) {
+    message_box_t *box = process->message;
+
+    if (box->stamp == MESSAGE_BOX_NO_STAMP) return;
+
+    if (process_pid < kernel->latency_size && kernel->clock != NULL) {
+        latency_record(
+            kernel->latency + process_pid, 
+            kernel->clock() - box->stamp
+        );
+    }
+
+    box->stamp = MESSAGE_BOX_NO_STAMP;
+}
+
+#endif
+
+/** \fn kernel_is_ready
+ * This check if process would be executed by scheduler.
+ * @param *process Process to check
+ * @return True if process is ready to execute
+ */
+static inline bool kernel_is_ready(process_t *process) {
+    process_type_t type = PROCESS_GET_TYPE(process);
+
+    if (type == EMPTY) return false;
+    if (type == CONTINUOUS) return true;
+
+    return message_box_is_readable(process->message);
+}
+
+/** \fn kernel_segment_scheduler
+ * This function run processes from one segment of process table. When it 
+ * stops on limit, it stores pid after last executed process in cursor.
+ * @param *kernel Kernel instance to work on
+ * @param *current First process of segment
+ * @param first Pid of first process
+ * @param count Count of processes to run over
+ * @param limit Max count of processes to execute
+ * @return Count of executed processes
+ */
+static inline uint_t kernel_segment_scheduler(
+    kernel_instance_t *kernel,
+    process_t *current,
+    kernel_pid_t first,
+    kernel_pid_t count,
+    uint_t limit
+) {
+    uint_t dispatched = 0x00;
+    process_t *start = current;
+
+    for (process_t *last = current + count; current < last; ++current) {
+        if (!kernel_is_ready(current)) continue;
+
+#ifdef AIKO_LATENCY
+        kernel_latency_record(
+            kernel, 
+            first + (kernel_pid_t)(current - start), 
+            current
+        );
+#endif
+            
+        PROCESS_GET_WORKER(current)(kernel, current);
+
+        if (++dispatched != limit) continue;
+
+        kernel->cursor = first + (kernel_pid_t)(current - start) + 1;
+        break;
+    }
+
+    return dispatched;
+}
+
+/** \fn kernel_range_scheduler
+ * This function run processes with pids from given range.
+ * @param *kernel Kernel instance to work on
+ * @param first First pid of range
+ * @param last Pid after last process of range
+ * @param limit Max count of processes to execute
+ * @return Count of executed processes
+ */
+static inline uint_t kernel_range_scheduler(
+    kernel_instance_t *kernel,
+    kernel_pid_t first,
+    kernel_pid_t last,
+    uint_t limit
+) {
+    if (first >= last || limit == 0x00) return 0x00;
+
+#ifdef AIKO_SEGMENTED_KERNEL
+    if (kernel->segments == NULL) {
+#endif
+        return kernel_segment_scheduler(
+            kernel, 
+            kernel->processes + first, 
+            first,
+            last - first, 
+            limit
+        );
+#ifdef AIKO_SEGMENTED_KERNEL
+    }
+
+    uint_t shift = kernel->segment_shift;
+    kernel_pid_t mask = (kernel_pid_t)((1U << shift) - 1);
+    uint_t dispatched = 0x00;
+
+    while (first < last && dispatched < limit) {
+        kernel_pid_t offset = first & mask;
+        kernel_pid_t count = mask - offset + 1;
+
+        if (count > last - first) count = last - first;
+
+        dispatched += kernel_segment_scheduler(
+            kernel, 
+            kernel->segments[first >> shift] + offset, 
+            first,
+            count,
+            limit - dispatched
+        );
+
+        first += count;
+    }
+
+    return dispatched;
+#endif
+}
+
+/** \fn kernel_task_scheduler
+ * This function run processes from first pid to given pid. Tasks posted 
+ * before this loop run before processes with their priority pid.
+ * @param *kernel Kernel instance to work on
+ * @param last Pid after last process to run
+ * @param limit Max count of processes to execute
+ * @return Count of executed processes
+ */
+static inline uint_t kernel_task_scheduler(
+    kernel_instance_t *kernel,
+    kernel_pid_t last,
+    uint_t limit
+) {
+    task_pool_t *pool = kernel->tasks;
+
+    if (pool == NULL || pool->pending == NULL) {
+        return kernel_range_scheduler(kernel, 0x00, last, limit);
+    }
+
+    task_t *task = task_pool_detach(pool);
+    kernel_pid_t first = 0x00;
+    uint_t dispatched = 0x00;
+
+    while (task != NULL) {
+        task_t *next = task->next;
+        task_function_t function = task->function;
+        void *argument = task->argument;
+        kernel_pid_t priority = task->priority;
+
+        if (priority > last) priority = last;
+
+        dispatched += kernel_range_scheduler(
+            kernel, 
+            first, 
+            priority, 
+            limit - dispatched
+        );
+
+        if (priority > first) first = priority;
+
+        task_pool_release(pool, task);
+        function(kernel, argument);
+        
+        task = next;
+    }
+
+    return dispatched + kernel_range_scheduler(
+        kernel, 
+        first, 
+        last, 
+        limit - dispatched
+    );
+}
+
 /** \fn kernel_standard_scheduler
  * This function run standard scheduler if any process is not marked to 
- * executed.
+ * executed. It runs only over part of table with living processes. When 
+ * previous loop had been stopped by limit, this one continues from cursor
+ * to end of table, and then runs tasks and processes from begin of table 
+ * to cursor, so processes with low pids do not starve others.
  * @param *kernel Kernel instance to work on
+ * @param limit Max count of processes to execute
+ * @return Count of executed processes
  */
-static inline void kernel_standard_scheduler(kernel_instance_t *kernel) {
-    for (kernel_pid_t count = 0; count < kernel->size; ++count) {
-        process_t *current = kernel->processes + count;
+static inline uint_t kernel_standard_scheduler(
+    kernel_instance_t *kernel,
+    uint_t limit
+) {
+    kernel_pid_t used = KERNEL_USED(kernel);
+    kernel_pid_t cursor = kernel->cursor;
+    uint_t dispatched = 0x00;
 
-        if (current->type == EMPTY) continue;
-        if (
-            current->type != CONTINUOUS &&
-            !message_box_is_readable(current->message)
-        ) continue;
-            
-        current->worker(kernel, current);
+    kernel->cursor = 0x00;
+
+    if (cursor == 0x00 || cursor >= used) {
+        return kernel_task_scheduler(kernel, used, limit);
     }
+
+    dispatched = kernel_range_scheduler(kernel, cursor, used, limit);
+
+    if (kernel->cursor != 0x00 || dispatched == limit) return dispatched;
+
+    return dispatched + kernel_task_scheduler(
+        kernel, 
+        cursor, 
+        limit - dispatched
+    );
 }
 
 /** \fn kernel_marked_scheduler
  * This run scheduler when any process had been market do execute on first
  * kernel loop.
  * @param *kernel Kernel to work on
+ * @return Count of executed processes
  */
-static inline void kernel_marked_scheduler(kernel_instance_t *kernel) {
+static inline uint_t kernel_marked_scheduler(kernel_instance_t *kernel) {
     kernel_pid_t last_changed = kernel->last_changed;
 
     kernel->last_changed = ERROR_PID;
-    process_t *current = kernel->processes + last_changed;
 
-    if (current->type == EMPTY) return;
+    if (last_changed >= kernel->size) return 0x00;
+
+    process_t *current = kernel_process(kernel, last_changed);
+
+    if (PROCESS_GET_TYPE(current) == EMPTY) return 0x00;
+
+#ifdef AIKO_LATENCY
+    kernel_latency_record(kernel, last_changed, current);
+#endif
+
+    PROCESS_GET_WORKER(current)(kernel, current);
+    return 0x01;
+}
+
+/** \fn kernel_pass_run
+ * This run one loop of scheduler, without statistics.
+ * @param *kernel Kernel instance to work on
+ * @param limit Max count of processes to execute
+ * @return Count of executed processes
+ */
+static inline uint_t kernel_pass_run(kernel_instance_t *kernel, uint_t limit) {
+    kernel_deferred_drain(kernel);
+
+    if (kernel->last_changed != ERROR_PID) {
+        return kernel_marked_scheduler(kernel);
+    }
 
-    current->worker(kernel, current);
+    return kernel_standard_scheduler(kernel, limit);
+}
+
+/** \fn kernel_pass
+ * This run one loop of scheduler. With AIKO_STATISTICS loop is recorded in
+ * statistics of kernel.
+ * @param *kernel Kernel instance to work on
+ * @param limit Max count of processes to execute
+ * @return Count of executed processes
+ */
+static inline uint_t kernel_pass(kernel_instance_t *kernel, uint_t limit) {
+#ifdef AIKO_STATISTICS
+    kernel_time_t start = 0x00;
+
+    if (kernel->clock != NULL) start = kernel->clock();
+
+    uint_t dispatched = kernel_pass_run(kernel, limit);
+
+    kernel_record_pass(kernel, start, dispatched);
+    return dispatched;
+#else
+    return kernel_pass_run(kernel, limit);
+#endif
 }
 
 /** \fn kernel_scheduler
@@ -114,15 +625,422 @@ static inline void kernel_marked_scheduler(kernel_instance_t *kernel) {
  * @param *kernel Kernel instance to work on
  */
 void kernel_scheduler(kernel_instance_t *kernel) {
-    while (true) {
-        if (kernel->size == 0x00) return;
+    while (kernel->size != 0x00) kernel_pass(kernel, MAX_UINT_VALUE);
+}
+
+/** \fn kernel_run_once
+ * This run one loop of scheduler and return. It can be used to run kernel 
+ * from event loop of other system.
+ * @param *kernel Kernel instance to work on
+ * @return True if there is still work to do, false if kernel is idle
+ */
+bool kernel_run_once(kernel_instance_t *kernel) {
+    if (kernel->size == 0x00) return false;
+
+    kernel_pass(kernel, MAX_UINT_VALUE);
+    return kernel_has_work(kernel);
+}
+
+/** \fn kernel_run_pass
+ * This run exactly one loop of scheduler, like kernel_run_once, but does 
+ * not check if there is still work to do after it.
+ * @param *kernel Kernel instance to work on
+ * @return Count of executed processes
+ */
+uint_t kernel_run_pass(kernel_instance_t *kernel) {
+    if (kernel->size == 0x00) return 0x00;
+
+    return kernel_pass(kernel, MAX_UINT_VALUE);
+}
+
+/** \fn kernel_run_for
+ * This run scheduler until given count of processes had been executed, or
+ * until kernel is idle. When limit stops loop, next call continues from 
+ * process after last executed one.
+ * @param *kernel Kernel instance to work on
+ * @param dispatches Max count of processes to execute
+ * @return Count of executed processes
+ */
+uint_t kernel_run_for(kernel_instance_t *kernel, uint_t dispatches) {
+    uint_t dispatched = 0x00;
+
+    while (dispatched < dispatches && kernel_has_work(kernel)) {
+        dispatched += kernel_pass(kernel, dispatches - dispatched);
+    }
+
+    return dispatched;
+}
 
-        if (kernel->last_changed != ERROR_PID) {
-            kernel_marked_scheduler(kernel);      
+/** \fn kernel_run_until
+ * This run scheduler until kernel clock reach deadline, or until kernel is
+ * idle. Without clock it run one loop.
+ * @param *kernel Kernel instance to work on
+ * @param deadline Time from kernel clock, when it should return
+ * @return Count of executed processes
+ */
+uint_t kernel_run_until(kernel_instance_t *kernel, kernel_time_t deadline) {
+    uint_t dispatched = 0x00;
+
+    if (kernel->clock == NULL) {
+        if (kernel_has_work(kernel)) {
+            dispatched = kernel_pass(kernel, MAX_UINT_VALUE);
+        }
+
+        return dispatched;
+    }
+
+    while (
+        (int32_t)(deadline - kernel->clock()) > 0 && 
+        kernel_has_work(kernel)
+    ) {
+        dispatched += kernel_pass(kernel, MAX_UINT_VALUE - dispatched);
+
+        if (dispatched == MAX_UINT_VALUE) break;
+    }
+
+    return dispatched;
+}
+
+/** \fn kernel_next_ready
+ * This return pid of process, which would be executed first by scheduler.
+ * It checks marked process, then continues from cursor to end of table 
+ * and wraps around to its begin, like scheduler does. Pending tasks run
+ * in the wrapped part, before processes with pids not lower than their 
+ * priority, so task can run before returned process. kernel_has_work 
+ * checks pending tasks too.
+ * @param *kernel Kernel instance to work on
+ * @return Pid of first ready process, or ERROR_PID when there is not any
+ */
+kernel_pid_t kernel_next_ready(kernel_instance_t *kernel) {
+    kernel_pid_t last_changed = kernel->last_changed;
+
+    if (last_changed < kernel->size) {
+        if (PROCESS_GET_TYPE(kernel_process(kernel, last_changed)) != EMPTY) {
+            return last_changed;
+        }
+    }
+
+    kernel_pid_t used = KERNEL_USED(kernel);
+    kernel_pid_t cursor = kernel->cursor;
+
+    if (cursor >= used) cursor = 0x00;
+
+    for (kernel_pid_t count = cursor; count < used; ++count) {
+        if (kernel_is_ready(kernel_process(kernel, count))) return count;
+    }
+
+    for (kernel_pid_t count = 0x00; count < cursor; ++count) {
+        if (kernel_is_ready(kernel_process(kernel, count))) return count;
+    }
+
+    return ERROR_PID;
+}
+
+/** \fn kernel_poll_is_requested
+ * This check if any of polls had been requested.
+ * @param *kernel Kernel instance to work on
+ * @return True if any poll is requested, false if not
+ */
+static inline bool kernel_poll_is_requested(kernel_instance_t *kernel) {
+    for (kernel_poll_t *poll = kernel->polls; poll; poll = poll->next) {
+        if (atomic_uint_load(&poll->requested) != 0x00) return true;
+    }
+
+    return false;
+}
+
+/** \fn kernel_has_work
+ * This check if scheduler has any work to do now, any process is ready,
+ * any work waits in deferred queue or any poll is requested.
+ * @param *kernel Kernel instance to work on
+ * @return True if kernel has work, false when it is idle
+ */
+bool kernel_has_work(kernel_instance_t *kernel) {
+    if (kernel->size == 0x00) return false;
+    if (kernel->deferred != NULL && deferred_peek(kernel->deferred) != NULL) {
+        return true;
+    }
+
+    if (kernel->tasks != NULL && kernel->tasks->pending != NULL) return true;
+    if (kernel->polls != NULL && kernel_poll_is_requested(kernel)) return true;
+
+    return kernel_next_ready(kernel) != ERROR_PID;
+}
+
+/** \fn kernel_set_clock
+ * This set clock of kernel, which is used by kernel_run_until.
+ * @param *kernel Kernel instance to work on
+ * @param (*clock)(void) Function, which return current time, or NULL
+ */
+void kernel_set_clock(
+    kernel_instance_t *kernel, 
+    kernel_time_t (*clock)(void)
+) {
+    kernel->clock = clock;
+
+#ifdef AIKO_STATISTICS
+    kernel_reset_statistics(kernel);
+#endif
+}
+
+#ifdef AIKO_LATENCY
+
+/** \fn kernel_set_latency
+ * This set histograms of latency, histogram index is pid of process. 
+ * Kernel must have clock, messages are stamped with it when they are send.
+ * @param *kernel Kernel instance to work on
+ * @param *histograms First of histograms, or NULL to stop recording
+ * @param count Count of histograms
+ */
+void kernel_set_latency(
+    kernel_instance_t *kernel,
+    latency_histogram_t *histograms,
+    kernel_pid_t count
+) {
+    if (histograms == NULL) count = 0x00;
+
+    latency_reset(histograms, count);
+
+    kernel->latency = histograms;
+    kernel->latency_size = count;
+}
+
+/** \fn kernel_record_latency
+ * This record latency of message in box of process, when it is stamped. 
+ * Scheduler calls it before each process, other schedulers must call it
+ * too.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process, which is going to be executed
+ */
+void kernel_record_latency(
+    kernel_instance_t *kernel, 
+    kernel_pid_t process_pid
+) {
+    if (process_pid >= kernel->size) return;
+
+    kernel_latency_record(
+        kernel, 
+        process_pid, 
+        kernel_process(kernel, process_pid)
+    );
+}
+
+#endif
+
+#ifdef AIKO_STATISTICS
+
+/** \fn kernel_reset_statistics
+ * This clear statistics of scheduler and start new window of them. Kernel 
+ * clock is used to measure time, kernel_set_clock resets statistics too.
+ * @param *kernel Kernel instance to work on
+ */
+void kernel_reset_statistics(kernel_instance_t *kernel) {
+    kernel->statistics.passes = 0x00;
+    kernel->statistics.idle_passes = 0x00;
+    kernel->statistics.dispatches = 0x00;
+    kernel->statistics.busy = 0x00;
+    kernel->statistics.window = 0x00;
+    kernel->statistics_start = 0x00;
+
+    if (kernel->clock != NULL) kernel->statistics_start = kernel->clock();
+}
+
+/** \fn kernel_get_statistics
+ * This copy statistics of scheduler from last reset. Without kernel clock,
+ * busy and window are zero.
+ * @param *kernel Kernel instance to work on
+ * @param *statistics Place to copy statistics into
+ */
+void kernel_get_statistics(
+    kernel_instance_t *kernel,
+    kernel_statistics_t *statistics
+) {
+    *statistics = kernel->statistics;
+
+    if (kernel->clock != NULL) {
+        statistics->window = kernel->clock() - kernel->statistics_start;
+    }
+}
+
+/** \fn kernel_load
+ * This return load of scheduler in percents, as part of window, when it was
+ * busy. Without time, it is part of loops, which executed any process.
+ * @param *statistics Statistics to work on
+ * @return Load from 0 to 100
+ */
+uint_t kernel_load(const kernel_statistics_t *statistics) {
+    uint32_t part = statistics->busy;
+    uint32_t whole = statistics->window;
+
+    if (whole == 0x00) {
+        part = statistics->passes - statistics->idle_passes;
+        whole = statistics->passes;
+    }
+
+    if (whole == 0x00) return 0x00;
+    if (part >= whole) return 100;
+
+    if (part > UINT32_MAX / 100) return (uint_t)(part / (whole / 100));
+
+    return (uint_t)(part * 100 / whole);
+}
+
+/** \fn kernel_record_pass
+ * This add one loop of scheduler into statistics. Scheduler calls it after
+ * each loop, other schedulers must call it too.
+ * @param *kernel Kernel instance to work on
+ * @param start Time from kernel clock, when loop started, or zero
+ * @param dispatched Count of processes executed in loop
+ */
+void kernel_record_pass(
+    kernel_instance_t *kernel,
+    kernel_time_t start,
+    uint_t dispatched
+) {
+    ++kernel->statistics.passes;
+
+    if (dispatched == 0x00) {
+        ++kernel->statistics.idle_passes;
+        return;
+    }
+
+    kernel->statistics.dispatches += dispatched;
+
+    if (kernel->clock != NULL) {
+        kernel->statistics.busy += kernel->clock() - start;
+    }
+}
+
+#endif
+
+/** \fn kernel_set_tasks
+ * This set pool of tasks, which can be posted by kernel_post.
+ * @param *kernel Kernel instance to work on
+ * @param *pool Pool of tasks, or NULL to remove it
+ */
+void kernel_set_tasks(kernel_instance_t *kernel, task_pool_t *pool) {
+    kernel->tasks = pool;
+}
+
+/** \fn kernel_post
+ * This post function, which would be called once by scheduler, in next 
+ * loop before process with priority pid. Task does not need pid, and it is
+ * returned into pool before function is called.
+ * @param *kernel Kernel instance to work on
+ * @param function Function to call, with kernel and argument
+ * @param *argument Argument of function
+ * @param priority Pid of process, before which task runs, or TASK_LAST
+ * @return True if task had been posted, false when pool is empty
+ */
+bool kernel_post(
+    kernel_instance_t *kernel,
+    task_function_t function,
+    void *argument,
+    kernel_pid_t priority
+) {
+    if (kernel->tasks == NULL) return false;
+
+    return task_pool_post(kernel->tasks, function, argument, priority);
+}
+
+/** \fn kernel_set_deferred
+ * This set queue, to which interrupts can post work for kernel. Scheduler 
+ * takes work out of it on begin of each loop.
+ * @param *kernel Kernel instance to work on
+ * @param *queue Deferred queue, or NULL to remove it
+ */
+void kernel_set_deferred(kernel_instance_t *kernel, deferred_t *queue) {
+    kernel->deferred = queue;
+}
+
+/** \fn kernel_add_poll
+ * This add poll to kernel. Call it before interrupts can request it.
+ * @param *kernel Kernel instance to work on
+ * @param *poll Poll to add, it must live as long as kernel
+ * @param function Function to call, with kernel and argument
+ * @param *argument Argument of function
+ */
+void kernel_add_poll(
+    kernel_instance_t *kernel,
+    kernel_poll_t *poll,
+    deferred_function_t function,
+    void *argument
+) {
+    poll->function = function;
+    poll->argument = argument;
+    poll->requested = 0x00;
+    poll->next = kernel->polls;
+
+    kernel->polls = poll;
+}
+
+/** \fn kernel_request_poll
+ * This request call of poll function in next loop of scheduler, and wakes
+ * scheduler up by deferred queue, when it has one. It is safe to call it 
+ * from interrupts.
+ * @param *kernel Kernel instance to work on
+ * @param *poll Poll to request
+ */
+void kernel_request_poll(kernel_instance_t *kernel, kernel_poll_t *poll) {
+    atomic_uint_store(&poll->requested, 0x01);
+
+    if (kernel->deferred != NULL) deferred_wake(kernel->deferred);
+}
+
+/** \fn kernel_poll_drain
+ * This call function of each requested poll once.
+ * @param *kernel Kernel instance to work on
+ */
+static inline void kernel_poll_drain(kernel_instance_t *kernel) {
+    for (kernel_poll_t *poll = kernel->polls; poll; poll = poll->next) {
+        if (atomic_uint_exchange(&poll->requested, 0x00) == 0x00) continue;
+
+        poll->function(kernel, poll->argument);
+    }
+}
+
+/** \fn kernel_deferred_drain
+ * This do work posted to deferred queue, each entry once, and then calls 
+ * requested polls. Messages for pid out of table, or for empty process, 
+ * are dropped. When message box of process is full, message is moved to 
+ * end of queue, so it waits for next call, and messages for other 
+ * processes are not blocked. Messages for one process are send in order 
+ * they was posted. Scheduler call it, so call it only when You run 
+ * processes without kernel_scheduler.
+ * @param *kernel Kernel instance to work on
+ */
+void kernel_deferred_drain(kernel_instance_t *kernel) {
+    deferred_t *queue = kernel->deferred;
+
+    if (kernel->polls != NULL) kernel_poll_drain(kernel);
+    if (queue == NULL) return;
+
+    uint_t count = deferred_count(queue);
+    deferred_entry_t *entry;
+
+    while (count-- > 0x00 && (entry = deferred_peek(queue)) != NULL) {
+        deferred_function_t function = entry->function;
+        kernel_pid_t pid = (kernel_pid_t)(entry->pid);
+        void *argument = entry->argument;
+
+        if (function != NULL) {
+            deferred_pop(queue);
+            function(kernel, argument);
             continue;
         }
-        
-        kernel_standard_scheduler(kernel);        
+
+        if (pid >= kernel->size || kernel_process_type(kernel, pid) == EMPTY) {
+            deferred_pop(queue);
+            continue;
+        }
+
+        if (!kernel_is_process_message_box_sendable(kernel, pid)) {
+            if (!deferred_requeue(queue)) return;
+            continue;
+        }
+
+        kernel_process_message_box_send(kernel, pid, argument);
+        deferred_pop(queue);
     }
 }
 
@@ -132,40 +1050,118 @@ void kernel_scheduler(kernel_instance_t *kernel) {
  * @return Empty pid for new process
  */
 kernel_pid_t kernel_get_empty_pid(kernel_instance_t *kernel) {
-    for (kernel_pid_t count = 0x00; count < kernel->size; ++count) {
-        if ((kernel->processes + count)->type == EMPTY) return count;
+    kernel_pid_t used = KERNEL_USED(kernel);
+
+    for (kernel_pid_t count = 0x00; count < used; ++count) {
+        if (kernel_process_type(kernel, count) == EMPTY) return count;
     }
 
+#ifdef AIKO_SEGMENTED_KERNEL
+    if (kernel->used < kernel->size) return kernel->used;
+
+    kernel_pid_t first_new = kernel->size;
+
+    if (kernel_grow(kernel)) return first_new;
+#endif
+
     return ERROR_PID;
 }
 
+/** \fn kernel_get_process
+ * This function return process with given pid.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process to get
+ * @return Process with given pid, or NULL when pid is out of table
+ */
+process_t* kernel_get_process(
+    kernel_instance_t *kernel, 
+    kernel_pid_t process_pid
+) {
+    if (process_pid >= kernel->size) return NULL;
+
+    return kernel_process(kernel, process_pid);
+}
+
+/** \fn kernel_get_handle
+ * This check pid once, and return handle of process with it. Handle can be
+ * used to send messages without checking pid again.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process
+ * @return Handle of process, with NULL process when pid is not living
+ */
+kernel_handle_t kernel_get_handle(
+    kernel_instance_t *kernel, 
+    kernel_pid_t process_pid
+) {
+    kernel_handle_t handle = { NULL, 0x00 };
+
+    if (process_pid >= kernel->size) return handle;
+
+    process_t *process = kernel_process(kernel, process_pid);
+
+    if (PROCESS_GET_TYPE(process) == EMPTY) return handle;
+
+    handle.process = process;
+    handle.generation = PROCESS_GET_GENERATION(process);
+
+    return handle;
+}
+
 /** \fn kernel_create_process
- * This will create new process in system from given params.
+ * This will create new process in system from given params. When process 
+ * with that pid is living, its handles become invalid.
  * @param *kernel Kernel instance to work on
  * @param process_pid Pid of new process
  * @param type Type of new process
  * @param (*worker)(...) Process worker, process main function
  * @param *parameter Parameter to worker
+ * @return True if process had been created, false when pid is out of table
+ *         or worker is not in PROCESS_WORKERS, then pid is not changed
  */
-void kernel_create_process(
+bool kernel_create_process(
     kernel_instance_t *kernel,
     kernel_pid_t process_pid,
     process_type_t type,
     void (*worker)(kernel_instance_t *, process_t *),
     void *parameter
 ) {
-    if (process_pid >= kernel->size) return;
+    process_t created;
+
+    if (process_pid > MAX_PID_VALUE) return false;
+    if (!process_set_worker(&created, (process_worker_t)(worker))) {
+        return false;
+    }
+
+#ifdef AIKO_SEGMENTED_KERNEL
+    while (process_pid >= kernel->size) {
+        if (!kernel_grow(kernel)) return false;
+    }
+#else
+    if (process_pid >= kernel->size) return false;
+#endif
     
-    process_t *process = kernel->processes + process_pid;
+    process_t *process = kernel_process(kernel, process_pid);
+    uint8_t generation = PROCESS_GET_GENERATION(process);
+
+    if (PROCESS_GET_TYPE(process) != EMPTY) ++generation;
 
     process_create(process);
+    PROCESS_SET_GENERATION(process, generation);
+    PROCESS_SET_TYPE(process, type);
+    process->worker = created.worker;
 
-    process->type = type;
+#ifndef AIKO_NO_PROCESS_PARAMETER
     process->parameter = parameter;
-    
-    process->worker = (void (*)(void *, void *)) (worker);
+#else
+    (void)(parameter);
+#endif
 
+#ifdef AIKO_SEGMENTED_KERNEL
+    if (process_pid >= kernel->used) kernel->used = process_pid + 1;
+#endif
     if (type == CONTINUOUS) kernel->last_changed = process_pid;
+
+    return true;
 }
 
 /** \fn kernel_kill_process
@@ -179,7 +1175,19 @@ void kernel_kill_process(
 ) {
     if (process_pid >= kernel->size) return;
 
-    (kernel->processes + process_pid)->type = EMPTY;
+    process_t *process = kernel_process(kernel, process_pid);
+
+    PROCESS_SET_TYPE(process, EMPTY);
+    PROCESS_SET_GENERATION(process, PROCESS_GET_GENERATION(process) + 1);
+
+#ifdef AIKO_SEGMENTED_KERNEL
+    if (process_pid + 1 != kernel->used) return;
+
+    while (
+        kernel->used > 0x00 && 
+        kernel_process_type(kernel, kernel->used - 1) == EMPTY
+    ) --kernel->used;
+#endif
 }
 
 #define FILLED (!kernel_is_process_message_box_sendable(kernel, count))
@@ -194,8 +1202,10 @@ void kernel_kill_process(
 void kernel_trigger_signal(kernel_instance_t *kernel, uintptr_t signal) {
     void* signal_as_pointer = (void *)signal;
 
-    for (kernel_pid_t count = 0x00; count < kernel->size; ++count) {
-        if ((kernel->processes + count)->type != SIGNAL) continue;
+    kernel_pid_t used = KERNEL_USED(kernel);
+
+    for (kernel_pid_t count = 0x00; count < used; ++count) {
+        if (kernel_process_type(kernel, count) != SIGNAL) continue;
         if (FILLED && CURRENT_PRIORITY_HIGHER) continue;
 
         kernel_process_message_box_send(kernel, count, signal_as_pointer);
@@ -216,8 +1226,10 @@ void kernel_trigger_signal(kernel_instance_t *kernel, uintptr_t signal) {
 void kernel_sum_signal(kernel_instance_t *kernel, uintptr_t new_signal) {
     void* signal_to_add = (void *)new_signal;
 
-    for (kernel_pid_t count = 0x00; count < kernel->size; ++count) {
-        if ((kernel->processes + count)->type != SIGNAL) continue;
+    kernel_pid_t used = KERNEL_USED(kernel);
+
+    for (kernel_pid_t count = 0x00; count < used; ++count) {
+        if (kernel_process_type(kernel, count) != SIGNAL) continue;
         
         if (kernel_is_process_message_box_sendable(kernel, count)) {
             kernel_process_message_box_send(kernel, count, signal_to_add);
@@ -249,9 +1261,9 @@ bool kernel_is_process_message_box_sendable(
 ) {
     if (process_pid >= kernel->size) return false;
 
-    return message_box_is_sendable(
-        (kernel->processes + process_pid)->message
-    );
+    process_t *process = kernel_process(kernel, process_pid);
+
+    return message_box_is_sendable(process->message);
 }
 
 /** \fn kernel_process_message_box_show
@@ -267,7 +1279,7 @@ void* kernel_process_message_box_show(
 ) {
     if (process_pid >= kernel->size) return 0x00;
 
-    return message_box_show((kernel->processes + process_pid)->message);
+    return message_box_show(kernel_process(kernel, process_pid)->message);
 }
 
 /** \fn kernel_process_message_box_send
@@ -283,8 +1295,40 @@ void kernel_process_message_box_send(
 ) {
     if (process_pid >= kernel->size) return;
 
-    message_box_send(
-        (kernel->processes + process_pid)->message,
-        message
-    );
+    process_t *process = kernel_process(kernel, process_pid);
+
+    message_box_send(process->message, message);
+
+#ifdef AIKO_LATENCY
+    kernel_latency_stamp(kernel, process);
+#endif
 }
+
+#ifdef AIKO_MESSAGE_PAYLOAD_SIZE
+
+/** \fn kernel_process_message_box_send_value
+ * This function copy data into payload of message box of process with given
+ * pid, and send it.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process to send
+ * @param *data Data to copy
+ * @param size Size of data in bytes
+ */
+void kernel_process_message_box_send_value(
+    kernel_instance_t *kernel,
+    kernel_pid_t process_pid,
+    const void *data,
+    size_t size
+) {
+    if (process_pid >= kernel->size) return;
+
+    process_t *process = kernel_process(kernel, process_pid);
+
+    message_box_send_value(process->message, data, size);
+
+#ifdef AIKO_LATENCY
+    kernel_latency_stamp(kernel, process);
+#endif
+}
+
+#endif
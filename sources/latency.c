@@ -0,0 +1,133 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "numbers.h"
+#include "latency.h"
+
+/** \fn latency_reset
+ * This clear histograms.
+ * @param *histograms First of histograms
+ * @param count Count of histograms
+ */
+void latency_reset(latency_histogram_t *histograms, uint_t count) {
+    for (uint_t histogram = 0x00; histogram < count; ++histogram) {
+        for (uint8_t bucket = 0x00; bucket < AIKO_LATENCY_BUCKETS; ++bucket) {
+            (histograms + histogram)->buckets[bucket] = 0x00;
+        }
+
+        (histograms + histogram)->max = 0x00;
+    }
+}
+
+/** \fn latency_record
+ * This add time to histogram.
+ * @param *histogram Histogram to work on
+ * @param time Time which message waited, in units of kernel clock
+ */
+void latency_record(latency_histogram_t *histogram, uint32_t time) {
+    uint8_t bucket = 0x00;
+
+    if (time > histogram->max) histogram->max = time;
+
+    while (time != 0x00 && bucket < AIKO_LATENCY_BUCKETS - 1) {
+        time >>= 1;
+        ++bucket;
+    }
+
+    if (histogram->buckets[bucket] == UINT16_MAX) {
+        for (uint8_t count = 0x00; count < AIKO_LATENCY_BUCKETS; ++count) {
+            histogram->buckets[count] >>= 1;
+        }
+    }
+
+    ++histogram->buckets[bucket];
+}
+
+/** \fn latency_count
+ * This return count of times in histogram.
+ * @param *histogram Histogram to work on
+ * @return Count of times
+ */
+uint32_t latency_count(const latency_histogram_t *histogram) {
+    uint32_t count = 0x00;
+
+    for (uint8_t bucket = 0x00; bucket < AIKO_LATENCY_BUCKETS; ++bucket) {
+        count += histogram->buckets[bucket];
+    }
+
+    return count;
+}
+
+/** \fn latency_percentile
+ * This return time, which is not exceeded by given percent of messages. It
+ * is upper bound of bucket, so it can be up to two times too big.
+ * @param *histogram Histogram to work on
+ * @param percent Percent, from 0 to 100
+ * @return Time in units of kernel clock
+ */
+uint32_t latency_percentile(
+    const latency_histogram_t *histogram, 
+    uint8_t percent
+) {
+    uint32_t count = latency_count(histogram);
+
+    if (count == 0x00) return 0x00;
+    if (percent > 100) percent = 100;
+
+    uint32_t target = (uint32_t)(((uint64_t)(count) * percent + 99) / 100);
+    uint32_t sum = 0x00;
+
+    if (target == 0x00) target = 0x01;
+
+    for (uint8_t bucket = 0x00; bucket < AIKO_LATENCY_BUCKETS - 1; ++bucket) {
+        sum += histogram->buckets[bucket];
+
+        if (sum < target) continue;
+
+        uint32_t bound = (uint32_t)((1ULL << bucket) - 1);
+
+        return (bound < histogram->max) ? bound : histogram->max;
+    }
+
+    return histogram->max;
+}
+
+/** \fn latency_dump
+ * This print p50, p99 and max of each histogram with any of times.
+ * @param *stream Stream to print into
+ * @param *histograms First of histograms, histogram index is pid
+ * @param count Count of histograms
+ */
+void latency_dump(
+    FILE *stream, 
+    const latency_histogram_t *histograms, 
+    uint_t count
+) {
+    fprintf(stream, "pid count p50 p99 max\n");
+
+    for (uint_t pid = 0x00; pid < count; ++pid) {
+        const latency_histogram_t *histogram = histograms + pid;
+        uint32_t messages = latency_count(histogram);
+
+        if (messages == 0x00) continue;
+
+        fprintf(
+            stream, 
+            "%lu %lu %lu %lu %lu\n", 
+            (unsigned long)(pid),
+            (unsigned long)(messages),
+            (unsigned long)(latency_percentile(histogram, 50)),
+            (unsigned long)(latency_percentile(histogram, 99)),
+            (unsigned long)(histogram->max)
+        );
+    }
+}
@@ -11,15 +11,41 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 #include "message_box.h"
 
+/** \fn message_box_set_readable
+ * This set readable flag of message box.
+ * @param *box Message box to work on
+ * @param readable New state of flag
+ */
+static inline void message_box_set_readable(
+    message_box_t *box, 
+    bool readable
+) {
+#ifndef AIKO_COMPACT_PROCESS
+    box->readable = readable;
+#else
+    if (readable) box->flags |= MESSAGE_BOX_READABLE;
+    else box->flags &= (uint8_t)(~MESSAGE_BOX_READABLE);
+#endif
+}
+
 /** \fn message_box_create
- * This prepare new message box to work.
+ * This prepare new message box to work. With AIKO_COMPACT_PROCESS all of 
+ * flags are cleared, box of process is prepared by process_create.
  * @param *box Message box to work on
  */
 void message_box_create(message_box_t *box) {
+#ifndef AIKO_COMPACT_PROCESS
     box->readable = false;
+#else
+    box->flags = 0x00;
+#endif
     box->message = NULL;
+#ifdef AIKO_LATENCY
+    box->stamp = MESSAGE_BOX_NO_STAMP;
+#endif
 }
 
 /** \fn message_box_is_readable
@@ -28,7 +54,7 @@ void message_box_create(message_box_t *box) {
  * @return True if message box is readable, or false if not
  */
 bool message_box_is_readable(message_box_t *box) {
-    return box->readable;
+    return MESSAGE_BOX_IS_READABLE(box);
 }
 
 /** \fn message_box_is_sendable
@@ -37,7 +63,7 @@ bool message_box_is_readable(message_box_t *box) {
  * @return True if message box is sendable, false if not
  */
 bool message_box_is_sendable(message_box_t *box) {
-    return !box->readable;
+    return !message_box_is_readable(box);
 }
 
 /** \fn message_box_send
@@ -46,8 +72,9 @@ bool message_box_is_sendable(message_box_t *box) {
  * @param *data Data to send
  */
 void message_box_send(message_box_t *box, void *data) {
-    box->readable = true;
     box->message = data;
+    MESSAGE_BOX_RELEASE();
+    message_box_set_readable(box, true);
 }
 
 /** \fn message_box_show
@@ -66,6 +93,57 @@ void* message_box_show(message_box_t *box) {
  * @return Message box content
  */
 void* message_box_receive(message_box_t *box) {
-    box->readable = false;
-    return box->message;
+    void *message = box->message;
+
+    MESSAGE_BOX_RELEASE();
+    message_box_set_readable(box, false);
+    return message;
 }
+
+#ifdef AIKO_MESSAGE_PAYLOAD_SIZE
+
+/** \fn message_box_send_value
+ * This function copy data into message box payload and send it. Message
+ * pointer would point to payload. When data is bigger than payload, it would
+ * not be send.
+ * @param *box Message box to work on
+ * @param *data Data to copy
+ * @param size Size of data in bytes
+ */
+void message_box_send_value(
+    message_box_t *box, 
+    const void *data, 
+    size_t size
+) {
+    if (size > AIKO_MESSAGE_PAYLOAD_SIZE) return;
+
+    memcpy(box->payload, data, size);
+    
+    box->message = box->payload;
+    MESSAGE_BOX_RELEASE();
+    message_box_set_readable(box, true);
+}
+
+/** \fn message_box_receive_value
+ * This function receive data from message box, and copy payload into given
+ * place. Payload is copied only when message had been send by value, when
+ * it had been send by pointer, data is not changed, and pointer can still 
+ * be read by message_box_show.
+ * @param *box Message box to work on
+ * @param *data Place to copy payload into
+ * @param size Size of data in bytes
+ * @return True if message had been send by value, false if not
+ */
+bool message_box_receive_value(message_box_t *box, void *data, size_t size) {
+    if (size > AIKO_MESSAGE_PAYLOAD_SIZE) size = AIKO_MESSAGE_PAYLOAD_SIZE;
+
+    bool by_value = (box->message == (void *)(box->payload));
+
+    if (by_value) memcpy(data, box->payload, size);
+
+    MESSAGE_BOX_RELEASE();
+    message_box_set_readable(box, false);
+    return by_value;
+}
+
+#endif
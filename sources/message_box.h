@@ -12,6 +12,61 @@
 #define CX_AIKO_MESSAGE_BOX_H_INCLUDED
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \def AIKO_MESSAGE_PAYLOAD_SIZE
+ * If You define it, for example -DAIKO_MESSAGE_PAYLOAD_SIZE=4, each message
+ * box would have inline payload of that count of bytes. Then small messages
+ * like sensor readings or commands can be send by value, without allocating
+ * memory for them. Remember to use same value in library and in project.
+ */
+#ifdef AIKO_MESSAGE_PAYLOAD_SIZE
+
+/** \def MESSAGE_BOX_SEND_TYPED
+ * This send value of given type into message box payload. When type does 
+ * not fit in payload, it would not compile.
+ * @param box Message box to work on
+ * @param type Type of value
+ * @param value Value to send
+ */
+#define MESSAGE_BOX_SEND_TYPED(box, type, value) do { \
+    type message_box_value = (value); \
+    (void)sizeof(char[sizeof(type) <= AIKO_MESSAGE_PAYLOAD_SIZE ? 1 : -1]); \
+    message_box_send_value((box), &message_box_value, sizeof(type)); \
+} while (0)
+
+/** \def MESSAGE_BOX_RECEIVE_TYPED
+ * This receive value of given type from message box payload into target.
+ * When type does not fit in payload, or target has other size than type, 
+ * it would not compile.
+ * @param box Message box to work on
+ * @param type Type of value
+ * @param target Variable to store value in
+ */
+#define MESSAGE_BOX_RECEIVE_TYPED(box, type, target) do { \
+    (void)sizeof(char[sizeof(type) <= AIKO_MESSAGE_PAYLOAD_SIZE ? 1 : -1]); \
+    (void)sizeof(char[sizeof(target) == sizeof(type) ? 1 : -1]); \
+    message_box_receive_value((box), &(target), sizeof(type)); \
+} while (0)
+
+#endif
+
+/** \def MESSAGE_BOX_NO_STAMP
+ * This is stamp of message box, which had not been send with time, used 
+ * only with AIKO_LATENCY.
+ */
+#define MESSAGE_BOX_NO_STAMP 0x00
+
+/** \def MESSAGE_BOX_READABLE
+ * This is bit of message box flags, which is set when box is readable, used
+ * only with AIKO_COMPACT_PROCESS.
+ */
+#define MESSAGE_BOX_READABLE 0x80
 
 /** \struct message_box_t
  * This struct is usable to sending commands between processes. System use it
@@ -20,16 +75,61 @@
  */
 typedef struct {
     
+#ifndef AIKO_COMPACT_PROCESS
     /* If message box is blank, it is false */
     bool readable;
+#else
+    /* Highest bit is readable flag, rest of bits is used by process */
+    uint8_t flags;
+#endif
 
     /* Pointer to message from other process */
     void *message;
 
+#ifdef AIKO_MESSAGE_PAYLOAD_SIZE
+    /* Message send by value, message pointer points here then */
+    uint8_t payload[AIKO_MESSAGE_PAYLOAD_SIZE];
+#endif
+
+#ifdef AIKO_LATENCY
+    /* Time of send from kernel clock, or MESSAGE_BOX_NO_STAMP */
+    uint32_t stamp;
+#endif
+
 } message_box_t;
 
+/** \def MESSAGE_BOX_RELEASE
+ * This keep message stored before message box is marked as readable, and 
+ * read before it is marked as sendable again, also for interrupts and 
+ * other threads.
+ */
+#define MESSAGE_BOX_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+
+#ifndef AIKO_COMPACT_PROCESS
+
+/** \def MESSAGE_BOX_IS_READABLE
+ * This return true if message box is readable, it can be inlined.
+ */
+#define MESSAGE_BOX_IS_READABLE(box) ((box)->readable)
+
+/** \def MESSAGE_BOX_SET_READABLE
+ * This mark message box as readable, it can be inlined.
+ */
+#define MESSAGE_BOX_SET_READABLE(box) ((box)->readable = true)
+
+#else
+
+#define MESSAGE_BOX_IS_READABLE(box) \
+    (((box)->flags & MESSAGE_BOX_READABLE) != 0x00)
+
+#define MESSAGE_BOX_SET_READABLE(box) \
+    ((box)->flags |= MESSAGE_BOX_READABLE)
+
+#endif
+
 /** \fn message_box_create
- * This prepare new message box to work.
+ * This prepare new message box to work. With AIKO_COMPACT_PROCESS all of 
+ * flags are cleared, box of process is prepared by process_create.
  * @param *box Message box to work on
  */
 void message_box_create(message_box_t *box);
@@ -70,4 +170,38 @@ void* message_box_show(message_box_t *box);
  */
 void* message_box_receive(message_box_t *box);
 
+#ifdef AIKO_MESSAGE_PAYLOAD_SIZE
+
+/** \fn message_box_send_value
+ * This function copy data into message box payload and send it. Message
+ * pointer would point to payload. When data is bigger than payload, it would
+ * not be send.
+ * @param *box Message box to work on
+ * @param *data Data to copy
+ * @param size Size of data in bytes
+ */
+void message_box_send_value(
+    message_box_t *box, 
+    const void *data, 
+    size_t size
+);
+
+/** \fn message_box_receive_value
+ * This function receive data from message box, and copy payload into given
+ * place. Payload is copied only when message had been send by value, when
+ * it had been send by pointer, data is not changed, and pointer can still 
+ * be read by message_box_show.
+ * @param *box Message box to work on
+ * @param *data Place to copy payload into
+ * @param size Size of data in bytes
+ * @return True if message had been send by value, false if not
+ */
+bool message_box_receive_value(message_box_t *box, void *data, size_t size);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
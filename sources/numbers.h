@@ -23,6 +23,11 @@
  */
 typedef unsigned int uint_t;
 
+/** \typedef int_t
+ * This is signed type with same size as uint_t.
+ */
+typedef int int_t;
+
 /** \def MAX_UINT_VALUE
  * This define maximum value of uint_t type.
  */
@@ -39,6 +44,11 @@ typedef unsigned int uint_t;
  */
 typedef uint8_t uint_t;
 
+/** \typedef int_t
+ * This is signed type with same size as uint_t.
+ */
+typedef int8_t int_t;
+
 /** \def MAX_UINT_VALUE
  * This define maximum value of uint_t type.
  */
@@ -0,0 +1,378 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "numbers.h"
+#include "process.h"
+#include "message_box.h"
+#include "kernel.h"
+#include "pipeline.h"
+
+/** \fn pipeline_create
+ * This prepare new pipeline to work.
+ * @param *pipeline Pipeline to work on
+ * @param *kernel Kernel, in which stages would be running
+ * @param *stages Static stages array
+ * @param size Size of stages array
+ */
+void pipeline_create(
+    pipeline_t *pipeline,
+    kernel_instance_t *kernel,
+    pipeline_stage_t *stages,
+    uint_t size
+) {
+    pipeline->kernel = kernel;
+    pipeline->stages = stages;
+    pipeline->size = size;
+    pipeline->count = 0x00;
+}
+
+/** \fn pipeline_add_stage
+ * This add new stage to pipeline. Stage function gets stage and item, and
+ * can emit new items by pipeline_emit.
+ * @param *pipeline Pipeline to work on
+ * @param (*function)(...) Stage function
+ * @param *parameter Parameter for stage function
+ * @param **queue Static queue array
+ * @param capacity Size of queue array
+ * @return Index of new stage, or PIPELINE_ERROR
+ */
+uint_t pipeline_add_stage(
+    pipeline_t *pipeline,
+    void (*function)(pipeline_stage_t *, void *),
+    void *parameter,
+    void **queue,
+    uint_t capacity
+) {
+    if (pipeline->count >= pipeline->size) return PIPELINE_ERROR;
+    if (capacity == 0x00) return PIPELINE_ERROR;
+
+    pipeline_stage_t *stage = pipeline->stages + pipeline->count;
+
+    stage->function = (void (*)(void *, void *)) (function);
+    stage->parameter = parameter;
+    stage->pipeline = pipeline;
+    stage->queue = queue;
+    stage->capacity = capacity;
+    stage->head = 0x00;
+    stage->depth = 0x00;
+    stage->max_depth = 0x00;
+    stage->reserved = 0x00;
+    stage->outputs_count = 0x00;
+    stage->order = PIPELINE_ERROR;
+    stage->holding = false;
+    stage->pid = ERROR_PID;
+
+    return pipeline->count++;
+}
+
+/** \fn pipeline_connect
+ * This connect output of one stage, with input of other stage.
+ * @param *pipeline Pipeline to work on
+ * @param from Index of stage, which emits items
+ * @param to Index of stage, which receives items
+ * @return True if stages had been connected, false if not
+ */
+bool pipeline_connect(pipeline_t *pipeline, uint_t from, uint_t to) {
+    if (from >= pipeline->count || to >= pipeline->count) return false;
+    if (from == to) return false;
+
+    pipeline_stage_t *stage = pipeline->stages + from;
+
+    if (stage->outputs_count >= PIPELINE_MAX_OUTPUTS) return false;
+
+    stage->outputs[stage->outputs_count++] = to;
+    return true;
+}
+
+/** \fn pipeline_is_input
+ * This check if one stage emits items into other stage.
+ * @param *from Stage which can emit
+ * @param to Index of stage which can receive
+ * @return True if from emits into to
+ */
+static inline bool pipeline_is_input(pipeline_stage_t *from, uint_t to) {
+    for (uint_t output = 0x00; output < from->outputs_count; ++output) {
+        if (from->outputs[output] == to) return true;
+    }
+
+    return false;
+}
+
+/** \fn pipeline_is_ready_to_order
+ * This check if all inputs of stage had been placed in topological order.
+ * @param *pipeline Pipeline to work on
+ * @param stage Index of stage to check
+ * @return True if stage can be placed in order
+ */
+static inline bool pipeline_is_ready_to_order(
+    pipeline_t *pipeline, 
+    uint_t stage
+) {
+    for (uint_t count = 0x00; count < pipeline->count; ++count) {
+        pipeline_stage_t *input = pipeline->stages + count;
+
+        if (input->order != PIPELINE_ERROR) continue;
+        if (pipeline_is_input(input, stage)) return false;
+    }
+
+    return true;
+}
+
+/** \fn pipeline_sort
+ * This place all stages in topological order.
+ * @param *pipeline Pipeline to work on
+ * @return True if stages had been sorted, false when there is cycle
+ */
+static bool pipeline_sort(pipeline_t *pipeline) {
+    for (uint_t count = 0x00; count < pipeline->count; ++count) {
+        (pipeline->stages + count)->order = PIPELINE_ERROR;
+    }
+
+    for (uint_t order = 0x00; order < pipeline->count; ++order) {
+        uint_t stage = 0x00;
+
+        for (; stage < pipeline->count; ++stage) {
+            if ((pipeline->stages + stage)->order != PIPELINE_ERROR) continue;
+            if (pipeline_is_ready_to_order(pipeline, stage)) break;
+        }
+
+        if (stage == pipeline->count) return false;
+
+        (pipeline->stages + stage)->order = order;
+    }
+
+    return true;
+}
+
+/** \fn pipeline_kill_started
+ * This kill processes of stages, which had been created before start of 
+ * pipeline failed, so nothing of it is left running.
+ * @param *pipeline Pipeline to work on
+ * @param count Count of stages, in topological order, to kill
+ */
+static void pipeline_kill_started(pipeline_t *pipeline, uint_t count) {
+    for (uint_t index = 0x00; index < pipeline->count; ++index) {
+        pipeline_stage_t *stage = pipeline->stages + index;
+
+        if (stage->order >= count) continue;
+
+        kernel_kill_process(pipeline->kernel, stage->pid);
+        stage->pid = ERROR_PID;
+    }
+}
+
+/** \fn pipeline_start
+ * This create processes for all stages. Stages get pids in topological 
+ * order, so when more stages are ready, scheduler runs earlier first.
+ * @param *pipeline Pipeline to work on
+ * @return True if pipeline had been started, false on cycle or no pids,
+ * then none of stages is left running
+ */
+bool pipeline_start(pipeline_t *pipeline) {
+    if (!pipeline_sort(pipeline)) return false;
+
+    kernel_instance_t *kernel = pipeline->kernel;
+    kernel_pid_t pid = 0x00;
+
+    for (uint_t order = 0x00; order < pipeline->count; ++order) {
+        pipeline_stage_t *stage = pipeline->stages;
+
+        while (stage->order != order) ++stage;
+
+        process_t *process = kernel_get_process(kernel, pid);
+
+        while (process != NULL && PROCESS_GET_TYPE(process) != EMPTY) {
+            process = kernel_get_process(kernel, ++pid);
+        }
+
+        bool created = kernel_create_process(
+            kernel, 
+            pid, 
+            REACTIVE, 
+            pipeline_stage_worker, 
+            stage
+        );
+
+        if (!created) {
+            pipeline_kill_started(pipeline, order);
+            return false;
+        }
+
+        stage->pid = pid++;
+    }
+
+    return true;
+}
+
+/** \fn pipeline_get_stage
+ * This return stage with given index.
+ * @param *pipeline Pipeline to work on
+ * @param stage Index of stage
+ * @return Stage, or NULL if it does not exists
+ */
+pipeline_stage_t* pipeline_get_stage(pipeline_t *pipeline, uint_t stage) {
+    if (stage >= pipeline->count) return NULL;
+
+    return pipeline->stages + stage;
+}
+
+/** \fn pipeline_has_place
+ * This check if there is place in queue of stage, which is not reserved.
+ * @param *stage Stage to check
+ * @return True if item can be pushed
+ */
+static inline bool pipeline_has_place(pipeline_stage_t *stage) {
+    return stage->depth + stage->reserved < stage->capacity;
+}
+
+/** \fn pipeline_enqueue
+ * This put item on end of stage queue, there must be place in queue.
+ * @param *stage Stage to work on
+ * @param *item Item to put
+ */
+static inline void pipeline_enqueue(pipeline_stage_t *stage, void *item) {
+    unsigned int position = (unsigned int)(stage->head) + stage->depth;
+
+    if (position >= stage->capacity) position -= stage->capacity;
+
+    stage->queue[position] = item;
+
+    if (++stage->depth > stage->max_depth) stage->max_depth = stage->depth;
+}
+
+/** \fn pipeline_feed
+ * This move first item from queue of stage, into message box of its process,
+ * when box is empty and all outputs have place for result.
+ * @param *pipeline Pipeline to work on
+ * @param *stage Stage to work on
+ */
+static void pipeline_feed(pipeline_t *pipeline, pipeline_stage_t *stage) {
+    kernel_instance_t *kernel = pipeline->kernel;
+
+    if (stage->depth == 0x00 || stage->holding) return;
+    if (!kernel_is_process_message_box_sendable(kernel, stage->pid)) return;
+
+    for (uint_t output = 0x00; output < stage->outputs_count; ++output) {
+        pipeline_stage_t *next = pipeline->stages + stage->outputs[output];
+
+        if (!pipeline_has_place(next)) return;
+    }
+
+    for (uint_t output = 0x00; output < stage->outputs_count; ++output) {
+        ++(pipeline->stages + stage->outputs[output])->reserved;
+    }
+
+    void *item = stage->queue[stage->head];
+
+    if (++stage->head == stage->capacity) stage->head = 0x00;
+
+    --stage->depth;
+    stage->holding = (stage->outputs_count != 0x00);
+
+    kernel_process_message_box_send(kernel, stage->pid, item);
+}
+
+/** \fn pipeline_release
+ * This release places in outputs, reserved for item of stage.
+ * @param *pipeline Pipeline to work on
+ * @param *stage Stage to work on
+ */
+static inline void pipeline_release(
+    pipeline_t *pipeline, 
+    pipeline_stage_t *stage
+) {
+    if (!stage->holding) return;
+
+    for (uint_t output = 0x00; output < stage->outputs_count; ++output) {
+        --(pipeline->stages + stage->outputs[output])->reserved;
+    }
+
+    stage->holding = false;
+}
+
+/** \fn pipeline_push
+ * This push item into queue of stage, for example from source of data.
+ * @param *stage Stage to work on
+ * @param *item Item to push
+ * @return True if item had been pushed, false when queue is full
+ */
+bool pipeline_push(pipeline_stage_t *stage, void *item) {
+    if (!pipeline_has_place(stage)) return false;
+
+    pipeline_enqueue(stage, item);
+    pipeline_feed(stage->pipeline, stage);
+
+    return true;
+}
+
+/** \fn pipeline_emit
+ * This push item into queues of all outputs of stage. When it is called 
+ * once in stage function, there is always place for item.
+ * @param *stage Stage to work on
+ * @param *item Item to emit
+ * @return True if item had been emitted, false when any output is full
+ */
+bool pipeline_emit(pipeline_stage_t *stage, void *item) {
+    pipeline_t *pipeline = stage->pipeline;
+
+    pipeline_release(pipeline, stage);
+
+    for (uint_t output = 0x00; output < stage->outputs_count; ++output) {
+        pipeline_stage_t *next = pipeline->stages + stage->outputs[output];
+
+        if (!pipeline_has_place(next)) return false;
+    }
+
+    for (uint_t output = 0x00; output < stage->outputs_count; ++output) {
+        pipeline_stage_t *next = pipeline->stages + stage->outputs[output];
+
+        pipeline_enqueue(next, item);
+        pipeline_feed(pipeline, next);
+    }
+
+    return true;
+}
+
+/** \fn pipeline_stage_depth
+ * This return count of items, waiting in queue of stage.
+ * @param *stage Stage to work on
+ * @return Count of items in queue
+ */
+uint_t pipeline_stage_depth(pipeline_stage_t *stage) {
+    return stage->depth;
+}
+
+/** \fn pipeline_stage_worker
+ * This is worker of all stage processes. With AIKO_COMPACT_PROCESS it must
+ * be in process_workers table.
+ * @param *kernel Kernel instance
+ * @param *process Stage process
+ */
+void pipeline_stage_worker(kernel_instance_t *kernel, process_t *process) {
+    pipeline_stage_t *stage = process->parameter;
+    pipeline_t *pipeline = stage->pipeline;
+    uint_t index = (uint_t)(stage - pipeline->stages);
+
+    (void)(kernel);
+
+    stage->function(stage, message_box_receive(process->message));
+
+    pipeline_release(pipeline, stage);
+    pipeline_feed(pipeline, stage);
+
+    for (uint_t count = 0x00; count < pipeline->count; ++count) {
+        pipeline_stage_t *input = pipeline->stages + count;
+
+        if (pipeline_is_input(input, index)) pipeline_feed(pipeline, input);
+    }
+}
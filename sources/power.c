@@ -0,0 +1,187 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef __AVR__
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "numbers.h"
+#include "kernel.h"
+#include "deferred.h"
+#include "power.h"
+
+#ifdef __AVR__
+
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+
+/** \fn power_sleep
+ * This put processor into sleep, when kernel has not any work, until any 
+ * interrupt comes. Instruction after sei is always executed before any 
+ * interrupt, so sleep starts before interrupt could be handled.
+ * @param *kernel Kernel instance to check
+ * @param mode Mode of sleep
+ * @return True if processor had been sleeping, false if kernel has work
+ */
+bool power_sleep(kernel_instance_t *kernel, power_mode_t mode) {
+    if (kernel->size == 0x00) return false;
+    if (!(SREG & _BV(SREG_I))) return false;
+
+    set_sleep_mode(mode);
+    cli();
+
+    if (kernel_has_work(kernel)) {
+        sei();
+        return false;
+    }
+
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+
+    return true;
+}
+
+/** \fn power_connect
+ * This does nothing on AVR, interrupts wake processor up by themselves.
+ * @param *kernel Kernel instance with deferred queue
+ */
+void power_connect(kernel_instance_t *kernel) {
+    (void)(kernel);
+}
+
+/** \fn power_disconnect
+ * This does nothing on AVR, interrupts wake processor up by themselves.
+ * @param *kernel Kernel instance with deferred queue
+ */
+void power_disconnect(kernel_instance_t *kernel) {
+    (void)(kernel);
+}
+
+#else
+
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+
+/** \def POWER_WAKE_SIGNAL
+ * This is signal, which wakes connected thread up. It is ignored by 
+ * default, so it does not end program when nobody waits for it.
+ */
+#define POWER_WAKE_SIGNAL SIGURG
+
+/* This store thread connected by power_connect */
+static pthread_t power_thread;
+
+/** \fn power_handler
+ * This handle wake signal, only to interrupt sigsuspend.
+ * @param signal Number of signal
+ */
+static void power_handler(int signal) {
+    (void)(signal);
+}
+
+/** \fn power_wake
+ * This wake connected thread up, it is called after each deferred post.
+ * @param *thread Connected thread
+ */
+static void power_wake(void *thread) {
+    pthread_kill(*(pthread_t *)(thread), POWER_WAKE_SIGNAL);
+}
+
+/* This store waker of connected thread, it is valid all time */
+static deferred_waker_t power_waker = { power_wake, &power_thread };
+
+/** \fn power_connect
+ * This connect deferred queue of kernel with current thread, so each post 
+ * wakes it up from power_sleep. Only one thread can be connected at once.
+ * Handler of wake signal is set for whole process.
+ * @param *kernel Kernel instance with deferred queue
+ */
+void power_connect(kernel_instance_t *kernel) {
+    if (kernel->deferred == NULL) return;
+
+    struct sigaction action;
+
+    memset(&action, 0x00, sizeof(action));
+    action.sa_handler = power_handler;
+    sigemptyset(&action.sa_mask);
+    sigaction(POWER_WAKE_SIGNAL, &action, NULL);
+
+    power_thread = pthread_self();
+    deferred_set_wake(kernel->deferred, &power_waker);
+}
+
+/** \fn power_disconnect
+ * This disconnect deferred queue of kernel, connected by power_connect. It 
+ * must be called before connected thread ends. It returns when no poster
+ * sends wake signal to the thread any more.
+ * @param *kernel Kernel instance with deferred queue
+ */
+void power_disconnect(kernel_instance_t *kernel) {
+    if (kernel->deferred == NULL) return;
+
+    deferred_set_wake(kernel->deferred, NULL);
+}
+
+/** \fn power_sleep
+ * This put thread into sleep, when kernel has not any work, until any 
+ * signal comes. Signals are blocked in current thread while kernel is 
+ * checked, and sigsuspend unblocks them at the same time when it starts 
+ * waiting, so wake signal send after check is never lost.
+ * @param *kernel Kernel instance to check
+ * @param mode Mode of sleep, it is not used
+ * @return True if thread had been sleeping, false if kernel has work
+ */
+bool power_sleep(kernel_instance_t *kernel, power_mode_t mode) {
+    (void)(mode);
+
+    if (kernel->size == 0x00) return false;
+
+    sigset_t all;
+    sigset_t saved;
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &saved);
+
+    if (kernel_has_work(kernel)) {
+        pthread_sigmask(SIG_SETMASK, &saved, NULL);
+        return false;
+    }
+
+    sigsuspend(&saved);
+    pthread_sigmask(SIG_SETMASK, &saved, NULL);
+
+    return true;
+}
+
+#endif
+
+/** \fn power_scheduler
+ * This is main system loop like kernel_scheduler, but processor sleeps in
+ * given mode when all processes wait for messages. Deferred queue of kernel
+ * is connected while it runs. It returns when kernel had been stopped.
+ * @param *kernel Kernel instance to work on
+ * @param mode Mode of sleep
+ */
+void power_scheduler(kernel_instance_t *kernel, power_mode_t mode) {
+    power_connect(kernel);
+
+    while (kernel->size != 0x00) {
+        if (!kernel_run_once(kernel)) power_sleep(kernel, mode);
+    }
+
+    power_disconnect(kernel);
+}
@@ -0,0 +1,95 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_POWER_H_INCLUDED
+#define CX_AIKO_POWER_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "numbers.h"
+#include "kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \typedef power_mode_t
+ * This is mode of sleep. On AVR it is one of SLEEP_MODE_ values from 
+ * avr/sleep.h, it depends on microcontroller which of them exists. On Linux
+ * mode is not used, thread waits for signal in each of modes, and other 
+ * threads and signal handlers play role of interrupts.
+ */
+typedef uint8_t power_mode_t;
+
+#ifdef __AVR__
+
+#include <avr/sleep.h>
+
+/** \def POWER_IDLE
+ * This is sleep mode, in which timers and UART still works.
+ */
+#define POWER_IDLE SLEEP_MODE_IDLE
+
+/** \def POWER_DOWN
+ * This is deepest sleep mode, only external interrupts can wake up.
+ */
+#define POWER_DOWN SLEEP_MODE_PWR_DOWN
+
+#else
+
+#define POWER_IDLE 0x00
+#define POWER_DOWN 0x02
+
+#endif
+
+/** \fn power_sleep
+ * This put processor into sleep, when kernel has not any work, until any 
+ * interrupt comes. On Linux signal is interrupt. Kernel is checked with 
+ * interrupts disabled, and they are enabled at the same time when sleep 
+ * starts, so interrupt which comes after check always wakes processor up.
+ * Interrupts must be enabled when it is called.
+ * @param *kernel Kernel instance to check
+ * @param mode Mode of sleep
+ * @return True if processor had been sleeping, false if kernel has work
+ */
+bool power_sleep(kernel_instance_t *kernel, power_mode_t mode);
+
+/** \fn power_connect
+ * This connect deferred queue of kernel with current thread, so each post 
+ * wakes it up from power_sleep. On Linux it sends SIGURG to the thread, 
+ * only one thread can be connected at once. It replaces handler of SIGURG
+ * for whole process, so application must not use SIGURG for own needs. 
+ * On AVR interrupts wake processor up by themselves, and it does nothing.
+ * @param *kernel Kernel instance with deferred queue
+ */
+void power_connect(kernel_instance_t *kernel);
+
+/** \fn power_disconnect
+ * This disconnect deferred queue of kernel, connected by power_connect. It 
+ * must be called before connected thread ends. It returns when no poster
+ * sends wake signal to the thread any more. Handler of SIGURG stays set.
+ * @param *kernel Kernel instance with deferred queue
+ */
+void power_disconnect(kernel_instance_t *kernel);
+
+/** \fn power_scheduler
+ * This is main system loop like kernel_scheduler, but processor sleeps in
+ * given mode when all processes wait for messages. Deferred queue of kernel
+ * is connected while it runs. It returns when kernel had been stopped.
+ * @param *kernel Kernel instance to work on
+ * @param mode Mode of sleep
+ */
+void power_scheduler(kernel_instance_t *kernel, power_mode_t mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -20,6 +20,65 @@
  * @param *process Process to work on
  */
 void process_create(process_t *process) {
-    process->type = EMPTY;
     message_box_create(process->message);
+    PROCESS_SET_TYPE(process, EMPTY);
+    PROCESS_SET_GENERATION(process, 0x00);
 }
+
+#ifndef AIKO_COMPACT_PROCESS
+
+/** \fn process_set_worker
+ * This set worker of process. With AIKO_COMPACT_PROCESS worker must be in
+ * process_workers table.
+ * @param *process Process to work on
+ * @param worker New worker of process
+ * @return True when worker had been set, false if not
+ */
+bool process_set_worker(process_t *process, process_worker_t worker) {
+    process->worker = worker;
+    return true;
+}
+
+#else
+
+/** \fn process_read_worker
+ * This read worker from table of workers.
+ * @param index Index of worker in table
+ * @return Worker from table
+ */
+static inline process_worker_t process_read_worker(uint8_t index) {
+#ifdef __AVR__
+    return (process_worker_t)(pgm_read_word(process_workers + index));
+#else
+    return process_workers[index];
+#endif
+}
+
+/** \fn process_get_worker
+ * This return worker of process from table of workers.
+ * @param *process Process to work on
+ * @return Worker of process
+ */
+process_worker_t process_get_worker(process_t *process) {
+    return process_read_worker(process->worker);
+}
+
+/** \fn process_set_worker
+ * This set worker of process. With AIKO_COMPACT_PROCESS worker must be in
+ * process_workers table.
+ * @param *process Process to work on
+ * @param worker New worker of process
+ * @return True when worker had been set, false if not
+ */
+bool process_set_worker(process_t *process, process_worker_t worker) {
+    for (uint8_t index = 0x00; index < process_workers_count; ++index) {
+        if (process_read_worker(index) != worker) continue;
+
+        process->worker = index;
+        return true;
+    }
+
+    return false;
+}
+
+#endif
@@ -14,6 +14,10 @@
 #include "message_box.h"
 #include "numbers.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /** \enum process_type_t
  * This store type of process.
  */
@@ -33,29 +37,195 @@ typedef enum {
 
 } process_type_t;
 
+/** \typedef process_worker_t
+ * This is type of process worker, as it is stored in process. First 
+ * parameter is kernel instance, second is process.
+ */
+typedef void (*process_worker_t)(void *, void *);
+
+/** \def PROCESS_TYPE_MASK
+ * This is mask of bits, which store process type.
+ */
+#define PROCESS_TYPE_MASK 0x03
+
+/** \def AIKO_COMPACT_PROCESS
+ * If You want to fit more processes on small 8 bit microcontrollers, You can
+ * use this switch. Then process type is packed into message box flags, and
+ * worker is stored as 8 bit index into const table of workers, which project
+ * must define by PROCESS_WORKERS. On AVR that table lives in flash.
+ */
+#ifdef AIKO_COMPACT_PROCESS
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+
+/** \def PROCESS_WORKERS_MEMORY
+ * This is attribute of memory, where table of workers is stored.
+ */
+#define PROCESS_WORKERS_MEMORY PROGMEM
+#else
+#define PROCESS_WORKERS_MEMORY
+#endif
+
+/** \def PROCESS_WORKERS
+ * This define table of workers, which can be used by processes. Project 
+ * must use it once, for example:
+ * PROCESS_WORKERS(PROCESS_WORKER(blink), PROCESS_WORKER(uart));
+ */
+#define PROCESS_WORKERS(...) \
+    const process_worker_t process_workers[] PROCESS_WORKERS_MEMORY = { \
+        __VA_ARGS__ \
+    }; \
+    const uint8_t process_workers_count = \
+        sizeof(process_workers) / sizeof(process_worker_t)
+
+/** \def PROCESS_WORKER
+ * This convert worker function to item of workers table.
+ */
+#define PROCESS_WORKER(worker) ((process_worker_t)(worker))
+
+/** \def PROCESS_GENERATION_MASK
+ * This is mask of message box flags, which store process generation.
+ */
+#define PROCESS_GENERATION_MASK 0x7C
+
+/** \var process_workers
+ * This is table of workers, defined by project with PROCESS_WORKERS.
+ */
+extern const process_worker_t process_workers[] PROCESS_WORKERS_MEMORY;
+
+/** \var process_workers_count
+ * This is count of workers in process_workers table.
+ */
+extern const uint8_t process_workers_count;
+
+#endif
+
+/** \def AIKO_NO_PROCESS_PARAMETER
+ * If You do not use parameter of processes, this switch remove it from 
+ * process, and save size of pointer per process.
+ */
+
 /** \struct process_t
  * This struct store process.
  */
 typedef struct {
     
-    /* This store type of process */
-    process_type_t type;
+#ifndef AIKO_COMPACT_PROCESS
+    /* Lowest bits store type, rest store generation, which changes when 
+     * process is killed */
+    uint8_t state;
+#endif
 
     /* This store process message box */
     message_box_t message[1];
 
+#ifndef AIKO_COMPACT_PROCESS
     /* This store process worker, process main function */
-    void (*worker)(void *, void *);
+    process_worker_t worker;
+#else
+    /* This store index of process worker in process_workers table */
+    uint8_t worker;
+#endif
 
+#ifndef AIKO_NO_PROCESS_PARAMETER
     /* This store parameter for process worker */
     void *parameter;
+#endif
 
 } process_t;
 
+#ifndef AIKO_COMPACT_PROCESS
+
+/** \def PROCESS_GENERATION_MASK
+ * This is mask of process state, which store process generation.
+ */
+#define PROCESS_GENERATION_MASK 0xFC
+
+/** \def PROCESS_GET_TYPE
+ * This return type of process.
+ */
+#define PROCESS_GET_TYPE(process) \
+    ((process_type_t)((process)->state & PROCESS_TYPE_MASK))
+
+/** \def PROCESS_SET_TYPE
+ * This set type of process.
+ */
+#define PROCESS_SET_TYPE(process, new_type) \
+    ((process)->state = (uint8_t)( \
+        ((process)->state & (uint8_t)(~PROCESS_TYPE_MASK)) | \
+        (new_type) \
+    ))
+
+/** \def PROCESS_GET_WORKER
+ * This return worker of process.
+ */
+#define PROCESS_GET_WORKER(process) ((process)->worker)
+
+/** \def PROCESS_GET_GENERATION
+ * This return generation of process.
+ */
+#define PROCESS_GET_GENERATION(process) \
+    ((uint8_t)(((process)->state & PROCESS_GENERATION_MASK) >> 2))
+
+/** \def PROCESS_SET_GENERATION
+ * This set generation of process. It has 6 bits, with AIKO_COMPACT_PROCESS
+ * it has only 5 bits, and it is stored in message box flags.
+ */
+#define PROCESS_SET_GENERATION(process, new_generation) \
+    ((process)->state = (uint8_t)( \
+        ((process)->state & (uint8_t)(~PROCESS_GENERATION_MASK)) | \
+        (((new_generation) << 2) & PROCESS_GENERATION_MASK) \
+    ))
+
+#else
+
+#define PROCESS_GET_TYPE(process) \
+    ((process_type_t)((process)->message->flags & PROCESS_TYPE_MASK))
+
+#define PROCESS_SET_TYPE(process, new_type) \
+    ((process)->message->flags = (uint8_t)( \
+        ((process)->message->flags & (uint8_t)(~PROCESS_TYPE_MASK)) | \
+        (new_type) \
+    ))
+
+#define PROCESS_GET_WORKER(process) (process_get_worker(process))
+
+#define PROCESS_GET_GENERATION(process) \
+    ((uint8_t)(((process)->message->flags & PROCESS_GENERATION_MASK) >> 2))
+
+#define PROCESS_SET_GENERATION(process, new_generation) \
+    ((process)->message->flags = (uint8_t)( \
+        ((process)->message->flags & (uint8_t)(~PROCESS_GENERATION_MASK)) | \
+        (((new_generation) << 2) & PROCESS_GENERATION_MASK) \
+    ))
+
+/** \fn process_get_worker
+ * This return worker of process from table of workers.
+ * @param *process Process to work on
+ * @return Worker of process
+ */
+process_worker_t process_get_worker(process_t *process);
+
+#endif
+
 /** \fn process_create
  * This create new process in space passed in parameter.
  * @param *process Process to work on
  */
 void process_create(process_t *process);
 
+/** \fn process_set_worker
+ * This set worker of process. With AIKO_COMPACT_PROCESS worker must be in
+ * process_workers table.
+ * @param *process Process to work on
+ * @param worker New worker of process
+ * @return True when worker had been set, false if not
+ */
+bool process_set_worker(process_t *process, process_worker_t worker);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
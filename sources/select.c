@@ -0,0 +1,210 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "numbers.h"
+#include "message_box.h"
+#include "kernel.h"
+#include "atomic.h"
+#include "select.h"
+
+/** \fn select_deliver
+ * This send set to process, when condition still holds and process does 
+ * not have message yet. It is called by scheduler from poll, so condition 
+ * is checked again after process had taken messages, and notify requested
+ * by interrupt is never lost.
+ * @param *kernel Kernel instance, not used
+ * @param *argument Set to work on
+ */
+static void select_deliver(void *kernel, void *argument) {
+    select_t *select = (select_t *)(argument);
+    critical_state_t state = critical_enter();
+
+    (void)(kernel);
+
+    bool ready = select->ready >= select->threshold;
+    bool sendable = kernel_is_process_message_box_sendable(
+        select->kernel, 
+        select->pid
+    );
+
+    if (ready && sendable) {
+        kernel_process_message_box_send(select->kernel, select->pid, select);
+    }
+
+    critical_leave(state);
+}
+
+/** \fn select_create
+ * This create set of channels for process. Process gets pointer to set as
+ * message, when condition holds. Set adds its poll to kernel.
+ * @param *select Set to work on
+ * @param *channels Message boxes, one for each channel
+ * @param size Count of channels
+ * @param threshold SELECT_ANY, SELECT_ALL, or count of channels
+ * @param *kernel Kernel with process
+ * @param pid Pid of process
+ */
+void select_create(
+    select_t *select,
+    message_box_t *channels,
+    uint_t size,
+    uint_t threshold,
+    kernel_instance_t *kernel,
+    kernel_pid_t pid
+) {
+    for (uint_t channel = 0x00; channel < size; ++channel) {
+        message_box_create(channels + channel);
+    }
+
+    if (threshold > size) threshold = size;
+    if (threshold == 0x00) threshold = SELECT_ANY;
+
+    select->channels = channels;
+    select->size = size;
+    select->threshold = threshold;
+    select->ready = 0x00;
+    select->kernel = kernel;
+    select->pid = pid;
+
+    kernel_add_poll(kernel, &select->poll, select_deliver, select);
+}
+
+/** \fn select_withdraw
+ * This remove set from message box of process, when condition does not 
+ * hold anymore, so process is not executed without enough of messages.
+ * @param *select Set to work on
+ */
+static inline void select_withdraw(select_t *select) {
+    if (select->ready >= select->threshold) return;
+
+    process_t *process = kernel_get_process(select->kernel, select->pid);
+
+    if (process == NULL) return;
+    if (!message_box_is_readable(process->message)) return;
+    if (message_box_show(process->message) != select) return;
+
+    message_box_receive(process->message);
+}
+
+/** \fn select_is_sendable
+ * This check if message can be send into channel.
+ * @param *select Set to work on
+ * @param channel Index of channel
+ * @return True if channel is empty, false if not
+ */
+bool select_is_sendable(select_t *select, uint_t channel) {
+    if (channel >= select->size) return false;
+
+    return message_box_is_sendable(select->channels + channel);
+}
+
+/** \fn select_send
+ * This send message into channel. When condition holds, it requests poll
+ * of set, and scheduler notifies process in its next loop.
+ * @param *select Set to work on
+ * @param channel Index of channel
+ * @param *message Message to send
+ * @return True if message had been send, false when channel is full
+ */
+bool select_send(select_t *select, uint_t channel, void *message) {
+    if (channel >= select->size) return false;
+
+    critical_state_t state = critical_enter();
+    message_box_t *box = select->channels + channel;
+
+    if (!message_box_is_sendable(box)) {
+        critical_leave(state);
+        return false;
+    }
+
+    message_box_send(box, message);
+
+    bool ready = ++select->ready >= select->threshold;
+
+    critical_leave(state);
+
+    if (ready) kernel_request_poll(select->kernel, &select->poll);
+
+    return true;
+}
+
+/** \fn select_is_ready
+ * This check if condition of set holds.
+ * @param *select Set to work on
+ * @return True if enough of channels have messages, false if not
+ */
+bool select_is_ready(select_t *select) {
+    return atomic_uint_load(&select->ready) >= select->threshold;
+}
+
+/** \fn select_take
+ * This take message from one channel. When condition does not hold after
+ * that, set which waits in message box of process is removed.
+ * @param *select Set to work on
+ * @param channel Index of channel
+ * @param **message Place to store message
+ * @return True if message had been taken, false when channel is empty
+ */
+bool select_take(select_t *select, uint_t channel, void **message) {
+    if (channel >= select->size) return false;
+
+    critical_state_t state = critical_enter();
+    message_box_t *box = select->channels + channel;
+
+    if (!message_box_is_readable(box)) {
+        critical_leave(state);
+        return false;
+    }
+
+    *message = message_box_receive(box);
+
+    bool ready = --select->ready >= select->threshold;
+
+    select_withdraw(select);
+    critical_leave(state);
+
+    if (ready) kernel_request_poll(select->kernel, &select->poll);
+
+    return true;
+}
+
+/** \fn select_take_all
+ * This take messages from all of channels at once. Empty channels give 
+ * NULL. Set which waits in message box of process is removed, so process 
+ * is not executed again before condition holds.
+ * @param *select Set to work on
+ * @param **messages Place to store messages, one for each channel
+ * @return Count of taken messages
+ */
+uint_t select_take_all(select_t *select, void **messages) {
+    critical_state_t state = critical_enter();
+    uint_t taken = 0x00;
+
+    for (uint_t channel = 0x00; channel < select->size; ++channel) {
+        message_box_t *box = select->channels + channel;
+
+        if (!message_box_is_readable(box)) {
+            messages[channel] = NULL;
+            continue;
+        }
+
+        messages[channel] = message_box_receive(box);
+        ++taken;
+    }
+
+    select->ready -= taken;
+    select_withdraw(select);
+
+    critical_leave(state);
+    return taken;
+}
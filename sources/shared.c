@@ -0,0 +1,552 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "numbers.h"
+#include "kernel.h"
+#include "shared.h"
+
+/** \def SHARED_MAGIC
+ * This is magic number of ready region.
+ */
+#define SHARED_MAGIC 0x41494B4FU
+
+/** \def SHARED_BLOCK_HEADER
+ * This is size of block header, which store length of message.
+ */
+#define SHARED_BLOCK_HEADER 8
+
+/** \def SHARED_ALIGN
+ * This align size to given power of two.
+ */
+#define SHARED_ALIGN(size, align) \
+    (((size) + (align) - 1) & ~((size_t)(align) - 1))
+
+/** \fn shared_offset
+ * This return offset of pool in region.
+ * @param boxes Count of boxes
+ * @param blocks Count of blocks
+ * @return Offset of first block in bytes
+ */
+static inline size_t shared_offset(uint32_t boxes, uint32_t blocks) {
+    size_t offset = SHARED_ALIGN(sizeof(shared_header_t), 64);
+
+    offset += sizeof(shared_box_t) * boxes;
+    return SHARED_ALIGN(offset + sizeof(uint32_t) * blocks, 64);
+}
+
+/** \fn shared_stride
+ * This return distance between blocks in pool.
+ * @param block_size Size of block
+ * @return Distance between blocks in bytes
+ */
+static inline size_t shared_stride(uint32_t block_size) {
+    return SHARED_BLOCK_HEADER + SHARED_ALIGN((size_t)(block_size), 8);
+}
+
+/** \fn shared_size
+ * This return size of whole region.
+ * @param boxes Count of boxes
+ * @param blocks Count of blocks
+ * @param block_size Size of block
+ * @return Size of region in bytes
+ */
+static inline size_t shared_size(
+    uint32_t boxes, 
+    uint32_t blocks, 
+    uint32_t block_size
+) {
+    return shared_offset(boxes, blocks) + shared_stride(block_size) * blocks;
+}
+
+/** \fn shared_layout
+ * This set addresses of region parts, from mapped header.
+ * @param *region Region to work on
+ */
+static void shared_layout(shared_region_t *region) {
+    shared_header_t *header = region->header;
+    uint8_t *base = (uint8_t *)(header);
+    size_t offset = SHARED_ALIGN(sizeof(shared_header_t), 64);
+
+    region->boxes = (shared_box_t *)(base + offset);
+    offset += sizeof(shared_box_t) * header->boxes;
+
+    region->next = (uint32_t *)(base + offset);
+    region->pool = base + shared_offset(header->boxes, header->blocks);
+    region->stride = shared_stride(header->block_size);
+}
+
+/** \fn shared_map
+ * This map shared memory object into current process.
+ * @param descriptor Descriptor of shared memory object
+ * @param size Size to map
+ * @return Address of mapped region, or NULL
+ */
+static shared_header_t* shared_map(int descriptor, size_t size) {
+    void *address = mmap(
+        NULL, 
+        size, 
+        PROT_READ | PROT_WRITE, 
+        MAP_SHARED, 
+        descriptor, 
+        0
+    );
+
+    if (address == MAP_FAILED) return NULL;
+
+    return address;
+}
+
+/** \fn shared_start
+ * This prepare local part of region.
+ * @param *region Region to work on
+ * @param size Size of mapped region
+ */
+static void shared_start(shared_region_t *region, size_t size) {
+    region->size = size;
+    region->bindings = NULL;
+    region->doorbell = __atomic_load_n(
+        &region->header->doorbell, 
+        __ATOMIC_ACQUIRE
+    );
+}
+
+/** \fn shared_create
+ * This create new shared memory region with given name.
+ * @param *region Region to work on
+ * @param *name Name of POSIX shared memory, like "/aiko"
+ * @param boxes Count of message boxes
+ * @param blocks Count of blocks in pool
+ * @param block_size Size of one block in bytes
+ * @return True if region had been created, false if not
+ */
+bool shared_create(
+    shared_region_t *region,
+    const char *name,
+    uint32_t boxes,
+    uint32_t blocks,
+    uint32_t block_size
+) {
+    size_t size = shared_size(boxes, blocks, block_size);
+    int descriptor = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+
+    if (descriptor < 0) return false;
+
+    if (ftruncate(descriptor, (off_t)(size)) != 0) {
+        close(descriptor);
+        shm_unlink(name);
+        return false;
+    }
+
+    region->header = shared_map(descriptor, size);
+    close(descriptor);
+
+    if (region->header == NULL) {
+        shm_unlink(name);
+        return false;
+    }
+
+    region->header->boxes = boxes;
+    region->header->blocks = blocks;
+    region->header->block_size = block_size;
+    
+    shared_layout(region);
+
+    for (uint32_t box = 0x00; box < boxes; ++box) {
+        (region->boxes + box)->readable = 0x00;
+        (region->boxes + box)->block = SHARED_ERROR;
+    }
+
+    for (uint32_t block = 0x00; block < blocks; ++block) {
+        region->next[block] = (block + 1 < blocks) ? block + 1 : SHARED_ERROR;
+    }
+
+    region->header->doorbell = 0x00;
+    region->header->sleepers = 0x00;
+    region->header->free = (blocks != 0x00) ? 0x00 : SHARED_ERROR;
+
+    __atomic_store_n(&region->header->magic, SHARED_MAGIC, __ATOMIC_RELEASE);
+
+    shared_start(region, size);
+    return true;
+}
+
+/** \fn shared_open
+ * This map existing shared memory region with given name.
+ * @param *region Region to work on
+ * @param *name Name of POSIX shared memory
+ * @return True if region had been mapped, false if not
+ */
+bool shared_open(shared_region_t *region, const char *name) {
+    int descriptor = shm_open(name, O_RDWR, 0600);
+    struct stat status;
+
+    if (descriptor < 0) return false;
+
+    if (fstat(descriptor, &status) != 0) {
+        close(descriptor);
+        return false;
+    }
+
+    size_t size = (size_t)(status.st_size);
+
+    if (size < sizeof(shared_header_t)) {
+        close(descriptor);
+        return false;
+    }
+
+    region->header = shared_map(descriptor, size);
+    close(descriptor);
+
+    if (region->header == NULL) return false;
+
+    shared_header_t *header = region->header;
+    uint32_t magic = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE);
+    
+    if (
+        magic != SHARED_MAGIC ||
+        shared_size(header->boxes, header->blocks, header->block_size) > size
+    ) {
+        munmap(header, size);
+        return false;
+    }
+
+    shared_layout(region);
+    shared_start(region, size);
+    return true;
+}
+
+/** \fn shared_close
+ * This unmap region from current process.
+ * @param *region Region to work on
+ */
+void shared_close(shared_region_t *region) {
+    free(region->bindings);
+    munmap(region->header, region->size);
+
+    region->bindings = NULL;
+    region->header = NULL;
+}
+
+/** \fn shared_unlink
+ * This remove name of shared memory region. Region exists until all of 
+ * processes close it.
+ * @param *name Name of POSIX shared memory
+ */
+void shared_unlink(const char *name) {
+    shm_unlink(name);
+}
+
+/** \fn shared_block
+ * This return address of block with given index.
+ * @param *region Region to work on
+ * @param index Index of block
+ * @return Address of block data
+ */
+static inline uint8_t* shared_block(shared_region_t *region, uint32_t index) {
+    return region->pool + region->stride * index + SHARED_BLOCK_HEADER;
+}
+
+/** \fn shared_index
+ * This return index of block with given address.
+ * @param *region Region to work on
+ * @param *block Address of block data
+ * @return Index of block, or SHARED_ERROR
+ */
+static inline uint32_t shared_index(shared_region_t *region, void *block) {
+    uint8_t *address = (uint8_t *)(block) - SHARED_BLOCK_HEADER;
+
+    if (address < region->pool) return SHARED_ERROR;
+
+    size_t offset = (size_t)(address - region->pool);
+
+    if (offset % region->stride != 0x00) return SHARED_ERROR;
+    if (offset / region->stride >= region->header->blocks) {
+        return SHARED_ERROR;
+    }
+
+    return (uint32_t)(offset / region->stride);
+}
+
+/** \fn shared_alloc
+ * This take free block from pool.
+ * @param *region Region to work on
+ * @return Address of block, or NULL when pool is empty
+ */
+void* shared_alloc(shared_region_t *region) {
+    uint64_t *free = &region->header->free;
+    uint64_t head = __atomic_load_n(free, __ATOMIC_ACQUIRE);
+    uint64_t next;
+    uint32_t index;
+
+    do {
+        index = (uint32_t)(head);
+
+        if (index == SHARED_ERROR) return NULL;
+
+        next = ((head >> 32) + 1) << 32;
+        next |= __atomic_load_n(region->next + index, __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(
+        free, 
+        &head, 
+        next, 
+        false, 
+        __ATOMIC_ACQ_REL, 
+        __ATOMIC_ACQUIRE
+    ));
+
+    return shared_block(region, index);
+}
+
+/** \fn shared_free
+ * This return block into pool.
+ * @param *region Region to work on
+ * @param *block Address of block
+ */
+void shared_free(shared_region_t *region, void *block) {
+    uint32_t index = shared_index(region, block);
+
+    if (index == SHARED_ERROR) return;
+
+    uint64_t *free = &region->header->free;
+    uint64_t head = __atomic_load_n(free, __ATOMIC_ACQUIRE);
+    uint64_t next;
+
+    do {
+        __atomic_store_n(
+            region->next + index, 
+            (uint32_t)(head), 
+            __ATOMIC_RELAXED
+        );
+
+        next = (((head >> 32) + 1) << 32) | index;
+    } while (!__atomic_compare_exchange_n(
+        free, 
+        &head, 
+        next, 
+        false, 
+        __ATOMIC_ACQ_REL, 
+        __ATOMIC_ACQUIRE
+    ));
+}
+
+/** \fn shared_futex
+ * This call futex syscall on shared doorbell.
+ * @param *address Futex word
+ * @param operation FUTEX_WAIT or FUTEX_WAKE
+ * @param value Expected value, or count of waked processes
+ * @param *timeout Timeout, or NULL
+ * @return Syscall result
+ */
+static inline long shared_futex(
+    uint32_t *address, 
+    int operation, 
+    uint32_t value,
+    struct timespec *timeout
+) {
+    return syscall(SYS_futex, address, operation, value, timeout, NULL, 0);
+}
+
+/** \fn shared_is_sendable
+ * This check if message can be send into box.
+ * @param *region Region to work on
+ * @param box Index of box
+ * @return True if box is sendable, false if not
+ */
+bool shared_is_sendable(shared_region_t *region, uint32_t box) {
+    if (box >= region->header->boxes) return false;
+
+    shared_box_t *target = region->boxes + box;
+
+    return __atomic_load_n(&target->readable, __ATOMIC_ACQUIRE) == 0x00;
+}
+
+/** \fn shared_send
+ * This send block from pool into box. Receiver owns block after that. 
+ * There is no syscall, when nobody sleeps on region.
+ * @param *region Region to work on
+ * @param box Index of box
+ * @param *block Block from pool
+ * @param length Length of message in bytes
+ * @return True if message had been send, false when box is full
+ */
+bool shared_send(
+    shared_region_t *region, 
+    uint32_t box, 
+    void *block, 
+    uint32_t length
+) {
+    uint32_t index = shared_index(region, block);
+    shared_header_t *header = region->header;
+
+    if (index == SHARED_ERROR) return false;
+    if (length > header->block_size) return false;
+    if (!shared_is_sendable(region, box)) return false;
+
+    shared_box_t *target = region->boxes + box;
+
+    *(uint32_t *)((uint8_t *)(block) - SHARED_BLOCK_HEADER) = length;
+    target->block = index;
+
+    __atomic_store_n(&target->readable, 0x01, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&header->doorbell, 0x01, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&header->sleepers, __ATOMIC_SEQ_CST) != 0x00) {
+        shared_futex(&header->doorbell, FUTEX_WAKE, INT_MAX, NULL);
+    }
+
+    return true;
+}
+
+/** \fn shared_receive
+ * This receive message from box. Receiver owns block after that, and must
+ * return it to pool by shared_free. When index of block in box is out of 
+ * pool, box is corrupt, it is emptied and message is dropped.
+ * @param *region Region to work on
+ * @param box Index of box
+ * @return Block with message, or NULL when box is empty or corrupt
+ */
+void* shared_receive(shared_region_t *region, uint32_t box) {
+    if (box >= region->header->boxes) return NULL;
+
+    shared_box_t *target = region->boxes + box;
+
+    if (__atomic_load_n(&target->readable, __ATOMIC_ACQUIRE) == 0x00) {
+        return NULL;
+    }
+
+    uint32_t index = target->block;
+
+    __atomic_store_n(&target->readable, 0x00, __ATOMIC_RELEASE);
+
+    if (index >= region->header->blocks) return NULL;
+
+    return shared_block(region, index);
+}
+
+/** \fn shared_length
+ * This return length of message in block, set when it had been send.
+ * @param *block Block from pool
+ * @return Length of message in bytes
+ */
+uint32_t shared_length(void *block) {
+    return *(uint32_t *)((uint8_t *)(block) - SHARED_BLOCK_HEADER);
+}
+
+/** \fn shared_bind
+ * This bind box to local process. shared_poll sends messages from box to 
+ * that process, as pointer to block.
+ * @param *region Region to work on
+ * @param box Index of box
+ * @param pid Pid of local process
+ * @return True if box had been bound, false if not
+ */
+bool shared_bind(shared_region_t *region, uint32_t box, kernel_pid_t pid) {
+    uint32_t boxes = region->header->boxes;
+
+    if (box >= boxes) return false;
+
+    if (region->bindings == NULL) {
+        region->bindings = malloc(sizeof(kernel_pid_t) * boxes);
+
+        if (region->bindings == NULL) return false;
+
+        for (uint32_t count = 0x00; count < boxes; ++count) {
+            region->bindings[count] = ERROR_PID;
+        }
+    }
+
+    region->bindings[box] = pid;
+    region->doorbell = region->header->doorbell - 1;
+    
+    return true;
+}
+
+/** \fn shared_poll
+ * This move messages from bound boxes into message boxes of local processes.
+ * When nothing had been send since last poll, it only reads one counter.
+ * @param *region Region to work on
+ * @param *kernel Kernel with local processes
+ * @return Count of moved messages
+ */
+uint_t shared_poll(shared_region_t *region, kernel_instance_t *kernel) {
+    uint32_t *counter = &region->header->doorbell;
+    uint32_t doorbell = __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+    uint32_t boxes = region->header->boxes;
+    uint_t moved = 0x00;
+    bool complete = true;
+
+    if (doorbell == region->doorbell || region->bindings == NULL) return 0x00;
+
+    for (uint32_t box = 0x00; box < boxes; ++box) {
+        kernel_pid_t pid = region->bindings[box];
+
+        if (pid == ERROR_PID) continue;
+        if (shared_is_sendable(region, box)) continue;
+
+        if (!kernel_is_process_message_box_sendable(kernel, pid)) {
+            complete = false;
+            continue;
+        }
+
+        void *block = shared_receive(region, box);
+
+        if (block == NULL) continue;
+
+        kernel_process_message_box_send(kernel, pid, block);
+        ++moved;
+    }
+
+    if (complete) region->doorbell = doorbell;
+
+    return moved;
+}
+
+/** \fn shared_wait
+ * This sleep on futex, until anything is send into region, or until timeout.
+ * @param *region Region to work on
+ * @param timeout Timeout in milliseconds, or negative to wait forever
+ * @return True when anything had been send, false on timeout
+ */
+bool shared_wait(shared_region_t *region, int32_t timeout) {
+    shared_header_t *header = region->header;
+    uint32_t seen = region->doorbell;
+    struct timespec time;
+    struct timespec *limit = NULL;
+
+    if (timeout >= 0) {
+        time.tv_sec = timeout / 1000;
+        time.tv_nsec = (long)(timeout % 1000) * 1000000L;
+        limit = &time;
+    }
+
+    __atomic_add_fetch(&header->sleepers, 0x01, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&header->doorbell, __ATOMIC_SEQ_CST) == seen) {
+        shared_futex(&header->doorbell, FUTEX_WAIT, seen, limit);
+    }
+
+    __atomic_sub_fetch(&header->sleepers, 0x01, __ATOMIC_SEQ_CST);
+
+    return __atomic_load_n(&header->doorbell, __ATOMIC_ACQUIRE) != seen;
+}
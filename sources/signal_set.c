@@ -0,0 +1,123 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "numbers.h"
+#include "process.h"
+#include "message_box.h"
+#include "kernel.h"
+#include "atomic.h"
+#include "signal_set.h"
+
+/** \fn signal_set_add
+ * This add signals into pending set of process, and then mark its message
+ * box readable.
+ * @param *process Process to work on
+ * @param signals Signals to add
+ */
+static inline void signal_set_add(process_t *process, uintptr_t signals) {
+    atomic_pointer_fetch_or(&process->message->message, signals);
+
+#ifndef AIKO_COMPACT_PROCESS
+    atomic_bool_store(&process->message->readable, true);
+#else
+    atomic_uint8_or(&process->message->flags, MESSAGE_BOX_READABLE);
+#endif
+}
+
+/** \fn signal_set_raise
+ * This add signal into pending set of each SIGNAL process, and make them 
+ * ready. Signals are never overwritten, and it can be called from 
+ * interrupts. Higher signal number has higher priority.
+ * @param *kernel Kernel instance to work on
+ * @param signal Number of signal, lower than SIGNAL_SET_SIZE
+ */
+void signal_set_raise(kernel_instance_t *kernel, uint_t signal) {
+    if (signal >= SIGNAL_SET_SIZE) return;
+
+    uintptr_t bit = (uintptr_t)(1) << signal;
+
+    kernel_pid_t used = KERNEL_USED(kernel);
+
+    for (kernel_pid_t count = 0x00; count < used; ++count) {
+        process_t *process = kernel_get_process(kernel, count);
+
+        if (PROCESS_GET_TYPE(process) != SIGNAL) continue;
+
+        signal_set_add(process, bit);
+    }
+}
+
+/** \fn signal_set_raise_process
+ * This add signal into pending set of one process, and make it ready. It 
+ * does nothing, when process is not SIGNAL process.
+ * @param *kernel Kernel instance to work on
+ * @param process_pid Pid of process
+ * @param signal Number of signal, lower than SIGNAL_SET_SIZE
+ */
+void signal_set_raise_process(
+    kernel_instance_t *kernel,
+    kernel_pid_t process_pid,
+    uint_t signal
+) {
+    if (signal >= SIGNAL_SET_SIZE) return;
+    
+    process_t *process = kernel_get_process(kernel, process_pid);
+
+    if (process == NULL) return;
+    if (PROCESS_GET_TYPE(process) != SIGNAL) return;
+
+    signal_set_add(process, (uintptr_t)(1) << signal);
+}
+
+/** \fn signal_set_take
+ * This take all of pending signals of process at once. Signals raised later
+ * make process ready again, so none of them is lost.
+ * @param *process Process to work on
+ * @return Set of signals, bit for each signal
+ */
+uintptr_t signal_set_take(process_t *process) {
+#ifndef AIKO_COMPACT_PROCESS
+    atomic_bool_store(&process->message->readable, false);
+#else
+    atomic_uint8_and(
+        &process->message->flags, 
+        (uint8_t)(~MESSAGE_BOX_READABLE)
+    );
+#endif
+
+    return (uintptr_t)(
+        atomic_pointer_exchange(&process->message->message, NULL)
+    );
+}
+
+/** \fn signal_set_pop
+ * This remove signal with highest priority from set.
+ * @param *set Set of signals
+ * @return Number of signal, or SIGNAL_SET_NONE when set is empty
+ */
+uint_t signal_set_pop(uintptr_t *set) {
+    uintptr_t signals = *set;
+
+    if (signals == 0x00) return SIGNAL_SET_NONE;
+
+    uint_t signal = SIGNAL_SET_SIZE - 1;
+    uint_t step = SIGNAL_SET_SIZE / 2;
+
+    while (step > 0x00) {
+        if ((signals >> (signal - step + 1)) == 0x00) signal -= step;
+        step /= 2;
+    }
+
+    *set = signals & ~((uintptr_t)(1) << signal);
+    return signal;
+}
@@ -0,0 +1,409 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "numbers.h"
+#include "process.h"
+#include "message_box.h"
+#include "kernel.h"
+#include "snapshot.h"
+
+/** \def SNAPSHOT_HEADER_SIZE
+ * This is size of snapshot header: magic, version, size of message, size
+ * of payload and count of records.
+ */
+#define SNAPSHOT_HEADER_SIZE 10
+
+/** \def SNAPSHOT_READABLE
+ * This is record flag of readable message box.
+ */
+#define SNAPSHOT_READABLE 0x04
+
+/** \def SNAPSHOT_VALUE
+ * This is record flag of message send by value.
+ */
+#define SNAPSHOT_VALUE 0x08
+
+/** \def SNAPSHOT_TYPE_MASK
+ * This is mask of record flags, which store process type.
+ */
+#define SNAPSHOT_TYPE_MASK 0x03
+
+/** \def SNAPSHOT_FLAGS_MASK
+ * This is mask of all record flags, which are known by this version.
+ */
+#define SNAPSHOT_FLAGS_MASK 0x0F
+
+#ifdef AIKO_MESSAGE_PAYLOAD_SIZE
+#define SNAPSHOT_PAYLOAD_SIZE AIKO_MESSAGE_PAYLOAD_SIZE
+#else
+#define SNAPSHOT_PAYLOAD_SIZE 0x00
+#endif
+
+/** \fn snapshot_write
+ * This write number in little endian.
+ * @param *buffer Place to write
+ * @param value Number to write
+ * @param bytes Count of bytes
+ */
+static inline void snapshot_write(
+    uint8_t *buffer, 
+    uint32_t value, 
+    uint8_t bytes
+) {
+    for (uint8_t count = 0x00; count < bytes; ++count) {
+        buffer[count] = (uint8_t)(value);
+        value >>= 8;
+    }
+}
+
+/** \fn snapshot_read
+ * This read number in little endian.
+ * @param *buffer Place to read
+ * @param bytes Count of bytes
+ * @return Read number
+ */
+static inline uint32_t snapshot_read(const uint8_t *buffer, uint8_t bytes) {
+    uint32_t value = 0x00;
+
+    while (bytes > 0x00) {
+        --bytes;
+        value = (value << 8) | buffer[bytes];
+    }
+
+    return value;
+}
+
+/** \fn snapshot_write_address
+ * This write address in little endian.
+ * @param *buffer Place to write
+ * @param address Address to write
+ */
+static inline void snapshot_write_address(uint8_t *buffer, void *address) {
+    uintptr_t value = (uintptr_t)(address);
+
+    for (uint8_t count = 0x00; count < sizeof(uintptr_t); ++count) {
+        buffer[count] = (uint8_t)(value);
+        value >>= 8;
+    }
+}
+
+/** \fn snapshot_read_address
+ * This read address in little endian.
+ * @param *buffer Place to read
+ * @return Read address
+ */
+static inline void *snapshot_read_address(const uint8_t *buffer) {
+    uintptr_t value = 0x00;
+
+    for (uint8_t count = sizeof(uintptr_t); count > 0x00; --count) {
+        value = (value << 8) | buffer[count - 1];
+    }
+
+    return (void *)(value);
+}
+
+/** \fn snapshot_is_value
+ * This check if message in box had been send by value.
+ * @param *box Message box to check
+ * @return True if message is in payload, false if not
+ */
+static inline bool snapshot_is_value(message_box_t *box) {
+#ifdef AIKO_MESSAGE_PAYLOAD_SIZE
+    return box->message == (void *)(box->payload);
+#else
+    (void)(box);
+    return false;
+#endif
+}
+
+/** \fn snapshot_record_size
+ * This return size of record of process.
+ * @param *process Process to work on
+ * @return Size of record in bytes
+ */
+static size_t snapshot_record_size(process_t *process) {
+    if (PROCESS_GET_TYPE(process) == EMPTY) return 0x01;
+    if (!message_box_is_readable(process->message)) return 0x03;
+    if (snapshot_is_value(process->message)) {
+        return 0x03 + SNAPSHOT_PAYLOAD_SIZE;
+    }
+
+    return 0x03 + sizeof(uintptr_t);
+}
+
+/** \fn snapshot_size
+ * This return size of buffer, which is required to save kernel.
+ * @param *kernel Kernel instance to work on
+ * @return Size of snapshot in bytes
+ */
+size_t snapshot_size(kernel_instance_t *kernel) {
+    size_t size = SNAPSHOT_HEADER_SIZE;
+
+    for (kernel_pid_t pid = 0x00; pid < KERNEL_USED(kernel); ++pid) {
+        size += snapshot_record_size(kernel_get_process(kernel, pid));
+    }
+
+    return size;
+}
+
+/** \fn snapshot_find
+ * This find entry of process in registry.
+ * @param *registry Registry of workers
+ * @param *process Process to find
+ * @return Index of entry, or SNAPSHOT_MAX_ENTRIES when it is not found
+ */
+static uint16_t snapshot_find(
+    const snapshot_registry_t *registry, 
+    process_t *process
+) {
+    process_worker_t worker = PROCESS_GET_WORKER(process);
+
+    for (uint16_t index = 0x00; index < registry->count; ++index) {
+        const snapshot_entry_t *entry = registry->entries + index;
+
+        if (entry->worker != worker) continue;
+#ifndef AIKO_NO_PROCESS_PARAMETER
+        if (entry->parameter != process->parameter) continue;
+#endif
+
+        return index;
+    }
+
+    return SNAPSHOT_MAX_ENTRIES;
+}
+
+/** \fn snapshot_save
+ * This save processes, their message boxes and pending signals to buffer.
+ * Messages are saved as numbers, pointers are valid only when restored in
+ * the same build, messages send by value are saved with payload.
+ * @param *kernel Kernel instance to work on
+ * @param *registry Registry of workers
+ * @param *buffer Buffer to save into
+ * @param size Size of buffer
+ * @return Count of written bytes, or 0 when process is not in registry or
+ *         buffer is too small
+ */
+size_t snapshot_save(
+    kernel_instance_t *kernel,
+    const snapshot_registry_t *registry,
+    uint8_t *buffer,
+    size_t size
+) {
+    if (size < snapshot_size(kernel)) return 0x00;
+
+    buffer[0] = 'A';
+    buffer[1] = 'K';
+    buffer[2] = SNAPSHOT_VERSION;
+    buffer[3] = sizeof(uintptr_t);
+    snapshot_write(buffer + 4, SNAPSHOT_PAYLOAD_SIZE, 2);
+    snapshot_write(buffer + 6, KERNEL_USED(kernel), 4);
+
+    uint8_t *cursor = buffer + SNAPSHOT_HEADER_SIZE;
+
+    for (kernel_pid_t pid = 0x00; pid < KERNEL_USED(kernel); ++pid) {
+        process_t *process = kernel_get_process(kernel, pid);
+        message_box_t *box = process->message;
+        uint8_t flags = (uint8_t)(PROCESS_GET_TYPE(process));
+
+        if (flags == EMPTY) {
+            *(cursor++) = flags;
+            continue;
+        }
+
+        uint16_t index = snapshot_find(registry, process);
+
+        if (index == SNAPSHOT_MAX_ENTRIES) return 0x00;
+        
+        if (message_box_is_readable(box)) flags |= SNAPSHOT_READABLE;
+        if (snapshot_is_value(box)) flags |= SNAPSHOT_VALUE;
+
+        *(cursor++) = flags;
+        snapshot_write(cursor, index, 2);
+        cursor += 2;
+
+        if (!(flags & SNAPSHOT_READABLE)) continue;
+
+#ifdef AIKO_MESSAGE_PAYLOAD_SIZE
+        if (flags & SNAPSHOT_VALUE) {
+            for (size_t byte = 0x00; byte < SNAPSHOT_PAYLOAD_SIZE; ++byte) {
+                *(cursor++) = box->payload[byte];
+            }
+
+            continue;
+        }
+#endif
+
+        snapshot_write_address(cursor, box->message);
+        cursor += sizeof(uintptr_t);
+    }
+
+    return (size_t)(cursor - buffer);
+}
+
+/** \fn snapshot_check
+ * This check whole snapshot, before anything is restored. It also check 
+ * that each worker used by snapshot can be set to process, and rejects 
+ * unknown flags and messages by value, when build has not payload.
+ * @param *kernel Kernel instance to work on
+ * @param *registry Registry of workers
+ * @param *buffer Buffer with snapshot
+ * @param size Size of buffer
+ * @return True if snapshot can be restored, false if not
+ */
+static bool snapshot_check(
+    kernel_instance_t *kernel,
+    const snapshot_registry_t *registry,
+    const uint8_t *buffer,
+    size_t size
+) {
+    if (size < SNAPSHOT_HEADER_SIZE) return false;
+    if (buffer[0] != 'A' || buffer[1] != 'K') return false;
+    if (buffer[2] != SNAPSHOT_VERSION) return false;
+    if (buffer[3] != sizeof(uintptr_t)) return false;
+    if (snapshot_read(buffer + 4, 2) != SNAPSHOT_PAYLOAD_SIZE) return false;
+
+    uint32_t count = snapshot_read(buffer + 6, 4);
+
+    if (count > (uint32_t)(MAX_PID_VALUE) + 1) return false;
+#ifdef AIKO_SEGMENTED_KERNEL
+    if (count > kernel->size && kernel->segments == NULL) return false;
+#else
+    if (count > kernel->size) return false;
+#endif
+
+    size_t offset = SNAPSHOT_HEADER_SIZE;
+
+    for (uint32_t pid = 0x00; pid < count; ++pid) {
+        if (offset >= size) return false;
+
+        uint8_t flags = buffer[offset++];
+
+        if (flags & (uint8_t)(~SNAPSHOT_FLAGS_MASK)) return false;
+        if ((flags & SNAPSHOT_TYPE_MASK) == EMPTY) {
+            if (flags != EMPTY) return false;
+            continue;
+        }
+
+        if ((flags & SNAPSHOT_VALUE) && SNAPSHOT_PAYLOAD_SIZE == 0x00) {
+            return false;
+        }
+
+        if (offset + 2 > size) return false;
+
+        uint32_t index = snapshot_read(buffer + offset, 2);
+        process_t probe;
+
+        if (index >= registry->count) return false;
+        if (!process_set_worker(&probe, registry->entries[index].worker)) {
+            return false;
+        }
+
+        offset += 2;
+
+        if (!(flags & SNAPSHOT_READABLE)) continue;
+        
+        if (flags & SNAPSHOT_VALUE) offset += SNAPSHOT_PAYLOAD_SIZE;
+        else offset += sizeof(uintptr_t);
+
+        if (offset > size) return false;
+    }
+
+    return true;
+}
+
+/** \fn snapshot_restore
+ * This restore processes from buffer. Buffer is checked and kernel is grown
+ * to size of snapshot before any process is changed, so broken snapshot 
+ * leaves processes untouched. Processes, which are not in snapshot, are 
+ * killed.
+ * @param *kernel Kernel instance to work on
+ * @param *registry Registry of workers
+ * @param *buffer Buffer with snapshot
+ * @param size Size of buffer
+ * @return True if kernel had been restored, false if not
+ */
+bool snapshot_restore(
+    kernel_instance_t *kernel,
+    const snapshot_registry_t *registry,
+    const uint8_t *buffer,
+    size_t size
+) {
+    if (!snapshot_check(kernel, registry, buffer, size)) return false;
+
+    uint32_t count = snapshot_read(buffer + 6, 4);
+    const uint8_t *cursor = buffer + SNAPSHOT_HEADER_SIZE;
+
+#ifdef AIKO_SEGMENTED_KERNEL
+    while (count > kernel->size) {
+        if (!kernel_grow(kernel)) return false;
+    }
+#endif
+
+    for (uint32_t pid = count; pid < KERNEL_USED(kernel); ++pid) {
+        kernel_kill_process(kernel, pid);
+    }
+
+    for (uint32_t pid = 0x00; pid < count; ++pid) {
+        uint8_t flags = *(cursor++);
+        process_type_t type = (process_type_t)(flags & SNAPSHOT_TYPE_MASK);
+
+        if (type == EMPTY) {
+            kernel_kill_process(kernel, pid);
+            continue;
+        }
+
+        const snapshot_entry_t *entry = registry->entries;
+        
+        entry += snapshot_read(cursor, 2);
+        cursor += 2;
+
+        bool created = kernel_create_process(
+            kernel,
+            pid,
+            type,
+            (void (*)(kernel_instance_t *, process_t *))(entry->worker),
+#ifndef AIKO_NO_PROCESS_PARAMETER
+            entry->parameter
+#else
+            NULL
+#endif
+        );
+
+        if (!created) return false;
+        if (!(flags & SNAPSHOT_READABLE)) continue;
+
+#ifdef AIKO_MESSAGE_PAYLOAD_SIZE
+        if (flags & SNAPSHOT_VALUE) {
+            kernel_process_message_box_send_value(
+                kernel, 
+                pid, 
+                cursor, 
+                SNAPSHOT_PAYLOAD_SIZE
+            );
+
+            cursor += SNAPSHOT_PAYLOAD_SIZE;
+            continue;
+        }
+#endif
+
+        kernel_process_message_box_send(
+            kernel,
+            pid,
+            snapshot_read_address(cursor)
+        );
+
+        cursor += sizeof(uintptr_t);
+    }
+
+    return true;
+}
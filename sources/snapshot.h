@@ -0,0 +1,112 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#ifndef CX_AIKO_SNAPSHOT_H_INCLUDED
+#define CX_AIKO_SNAPSHOT_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "numbers.h"
+#include "process.h"
+#include "kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \def SNAPSHOT_VERSION
+ * This is version of snapshot format.
+ */
+#define SNAPSHOT_VERSION 0x01
+
+/** \def SNAPSHOT_MAX_ENTRIES
+ * This define max count of entries in registry.
+ */
+#define SNAPSHOT_MAX_ENTRIES 0xFFFF
+
+/** \struct snapshot_entry_t
+ * This struct store one entry of registry. Snapshot store index of entry 
+ * instead of worker address, which changes between builds.
+ */
+typedef struct {
+
+    /* This store worker of process */
+    process_worker_t worker;
+
+#ifndef AIKO_NO_PROCESS_PARAMETER
+    /* This store parameter of process */
+    void *parameter;
+#endif
+
+} snapshot_entry_t;
+
+/** \struct snapshot_registry_t
+ * This struct store registry of workers, which can be saved in snapshot. 
+ * Project must give the same entries in the same order in each build.
+ */
+typedef struct {
+
+    /* This store address of first entry */
+    const snapshot_entry_t *entries;
+
+    /* This store count of entries */
+    uint16_t count;
+
+} snapshot_registry_t;
+
+/** \fn snapshot_size
+ * This return size of buffer, which is required to save kernel.
+ * @param *kernel Kernel instance to work on
+ * @return Size of snapshot in bytes
+ */
+size_t snapshot_size(kernel_instance_t *kernel);
+
+/** \fn snapshot_save
+ * This save processes, their message boxes and pending signals to buffer.
+ * Messages are saved as numbers, pointers are valid only when restored in
+ * the same build, messages send by value are saved with payload.
+ * @param *kernel Kernel instance to work on
+ * @param *registry Registry of workers
+ * @param *buffer Buffer to save into
+ * @param size Size of buffer
+ * @return Count of written bytes, or 0 when process is not in registry or
+ *         buffer is too small
+ */
+size_t snapshot_save(
+    kernel_instance_t *kernel,
+    const snapshot_registry_t *registry,
+    uint8_t *buffer,
+    size_t size
+);
+
+/** \fn snapshot_restore
+ * This restore processes from buffer. Buffer is checked and kernel is grown
+ * to size of snapshot before any process is changed, so broken snapshot 
+ * leaves processes untouched. Processes, which are not in snapshot, are 
+ * killed.
+ * @param *kernel Kernel instance to work on
+ * @param *registry Registry of workers
+ * @param *buffer Buffer with snapshot
+ * @param size Size of buffer
+ * @return True if kernel had been restored, false if not
+ */
+bool snapshot_restore(
+    kernel_instance_t *kernel,
+    const snapshot_registry_t *registry,
+    const uint8_t *buffer,
+    size_t size
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * This project is Aiko, an operating system for weak devices like 
+ * microcontrollers. It has support for devices based on eight-bit 
+ * architectures. It is suitable even for devices with only 128 bytes 
+ * of operational memory. You can make it easier to code your projects 
+ * based on such platforms by using Aiko as a scheduler.
+ *
+ * Author: Cixo
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "numbers.h"
+#include "task.h"
+
+/** \fn task_pool_create
+ * This create pool of tasks in given memory.
+ * @param *pool Pool to work on
+ * @param *tasks Memory for tasks
+ * @param size Count of tasks
+ */
+void task_pool_create(task_pool_t *pool, task_t *tasks, uint_t size) {
+    pool->free = NULL;
+    pool->pending = NULL;
+    pool->last = NULL;
+
+    while (size > 0x00) task_pool_release(pool, tasks + (--size));
+}
+
+/** \fn task_pool_post
+ * This take task from free list and put it into pending list.
+ * @param *pool Pool to work on
+ * @param function Function to call
+ * @param *argument Argument of function
+ * @param priority Pid of process, before which task runs, or TASK_LAST
+ * @return True if task had been posted, false when pool is empty
+ */
+bool task_pool_post(
+    task_pool_t *pool,
+    task_function_t function,
+    void *argument,
+    uint_t priority
+) {
+    task_t *task = pool->free;
+
+    if (task == NULL) return false;
+
+    pool->free = task->next;
+
+    task->function = function;
+    task->argument = argument;
+    task->priority = priority;
+    task->next = NULL;
+
+    if (pool->last == NULL) {
+        pool->pending = task;
+        pool->last = task;
+        return true;
+    }
+
+    if (pool->last->priority <= priority) {
+        pool->last->next = task;
+        pool->last = task;
+        return true;
+    }
+
+    task_t **place = &pool->pending;
+
+    while ((*place)->priority <= priority) place = &(*place)->next;
+
+    task->next = *place;
+    *place = task;
+
+    return true;
+}
+
+/** \fn task_pool_detach
+ * This take all of pending tasks, tasks posted later wait for next detach.
+ * @param *pool Pool to work on
+ * @return First of pending tasks, or NULL
+ */
+task_t* task_pool_detach(task_pool_t *pool) {
+    task_t *pending = pool->pending;
+
+    pool->pending = NULL;
+    pool->last = NULL;
+
+    return pending;
+}